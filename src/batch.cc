@@ -0,0 +1,255 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Batch solving: many cubes solved with the same pattern databases
+  */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <climits>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include "batch.hh"
+
+using namespace std;
+
+/*
+ * Faces in the order of Rubik::turn
+ */
+static const char faces[] = "LRUDFB";
+
+/*
+ * State shared by the threads of a batch
+ */
+typedef struct Batch Batch;
+
+struct Batch {
+    const Solver *solver;
+    FILE *in;
+    FILE *out;
+    mutex input;        //Guards in and lines
+    mutex output;       //Guards out and solved
+    long lines;         //Lines read
+    long solved;        //Cubes solved
+};
+
+
+/**
+  * Reads a cube
+  * @param 'line'  : scramble or configuration (see batch.hh)
+  * @param 'cube'  : where the cube is stored
+  * @param 'error' : where the reason is stored when the line is wrong
+  * @return True if the line holds a cube that can be solved
+  */
+
+bool parseCube(const char *line, Rubik *cube, string *error) {
+    while (isspace(*line))
+        line++;
+
+    cube->clean();
+    cube->transformToGoal();
+    if (isdigit(*line)) {
+        int i;
+        for (i = 0; i < 20; i++) {
+            char *end;
+            long position = strtol(line, &end, 10);
+            if (end == line) {
+                *error = "a configuration has 20 positions and orientations";
+                return false;
+            }
+            line = end;
+            long orientation = strtol(line, &end, 10);
+            if (end == line) {
+                *error = "a configuration has 20 positions and orientations";
+                return false;
+            }
+            line = end;
+
+            if ((position < 0) || (position >= 20) || ((orientation != 1) &&
+                (orientation != 2) && (orientation != 4))) {
+                *error = "positions go from 0 to 19, orientations are 1, 2 "
+                         "or 4";
+                return false;
+            }
+            cube->setCubie(i, (position << 3) | orientation);
+        }
+
+        while (isspace(*line))
+            line++;
+        if (*line != '\0') {
+            *error = "a configuration has 20 positions and orientations";
+            return false;
+        }
+    }
+    else {
+        while (*line != '\0') {
+            const char *face = strchr(faces, *line);
+            if (face == NULL) {
+                *error = string("unknown move ") + *line;
+                return false;
+            }
+            line++;
+
+            int times = 1;
+            if (*line == '2')
+                times = 2;
+            else if (*line == '\'')
+                times = 3;
+            if (times > 1)
+                line++;
+
+            if ((*line != '\0') && !isspace(*line)) {
+                *error = string("unknown move ") + *(line - 1);
+                return false;
+            }
+            cube->turn(face - faces, times);
+
+            while (isspace(*line))
+                line++;
+        }
+    }
+
+    if (!cube->isValid()) {
+        *error = "the cube can't be solved";
+        return false;
+    }
+
+    return true;
+};
+
+
+/**
+  * Writes a sequence of moves
+  * @param 'path' : moves as Solution keeps them (last move first)
+  * @return Moves separated by spaces (see batch.hh)
+  */
+
+string formatMoves(const list<char> &path) {
+    string moves;
+    list<char>::const_reverse_iterator it;
+    for (it = path.rbegin(); it != path.rend(); ++it) {
+        if (*it == '\x00')       //Root node
+            continue;
+
+        int m = *it - 'A';
+        if (!moves.empty())
+            moves += ' ';
+        moves += faces[m / 3];
+        if (m % 3 == 1)
+            moves += '2';
+        else if (m % 3 == 2)
+            moves += '\'';
+    }
+
+    return moves;
+};
+
+
+/**
+  * Reads a whole line, however long it is
+  * @param 'in'   : file
+  * @param 'line' : where the line is stored, without the end of line
+  * @return False at the end of the file
+  */
+
+static bool readLine(FILE *in, string *line) {
+    char buffer[256];
+    line->clear();
+    while (fgets(buffer, sizeof(buffer), in) != NULL) {
+        *line += buffer;
+        if ((*line)[line->size() - 1] == '\n') {
+            line->erase(line->size() - 1);
+            return true;
+        }
+    }
+
+    return !line->empty();
+};
+
+
+/**
+  * Thread of a batch. Takes lines until there are none left, and writes
+  * every result as soon as the cube is solved
+  * @param 'batch' : batch
+  */
+
+static void solveLines(Batch *batch) {
+    string line;
+    while (true) {
+        long number;
+        {
+            lock_guard<mutex> guard(batch->input);
+            if (!readLine(batch->in, &line))
+                return;
+            number = ++batch->lines;
+        }
+
+        //Blank lines and comments
+        size_t first = line.find_first_not_of(" \t\r");
+        if ((first == string::npos) || (line[first] == '#'))
+            continue;
+
+        Rubik cube;
+        string error;
+        if (!parseCube(line.c_str(), &cube, &error)) {
+            lock_guard<mutex> guard(batch->output);
+            fprintf(batch->out, "%ld\terror\t%s\n", number, error.c_str());
+            fflush(batch->out);
+            continue;
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        Solution sol = batch->solver->solve(cube);
+        chrono::duration<double, milli> time =
+            chrono::steady_clock::now() - start;
+
+        lock_guard<mutex> guard(batch->output);
+        if (sol.cost == INT_MAX)
+            fprintf(batch->out, "%ld\terror\tno solution found\n", number);
+        else {
+            fprintf(batch->out, "%ld\t%d\t%ld\t%.1f\t%s\n", number, sol.cost,
+                    sol.nodes, time.count(), formatMoves(sol.path).c_str());
+            batch->solved++;
+        }
+        fflush(batch->out);
+    }
+};
+
+
+/**
+  * Solves every cube of a file, several at once, and writes a line for
+  * every cube as soon as it is solved: the number of its line, the length
+  * of the solution, the nodes expanded, the milliseconds taken and the
+  * moves, separated by tabs (or the number of its line, "error" and the
+  * reason). Results come in the order the cubes are solved
+  * @param 'solver'  : solver shared by the threads
+  * @param 'in'      : cubes, one per line (see batch.hh)
+  * @param 'out'     : where the results are written
+  * @param 'threads' : number of cubes solved at once
+  * @return The number of cubes solved
+  */
+
+long solveBatch(const Solver &solver, FILE *in, FILE *out, int threads) {
+    Batch batch;
+    batch.solver = &solver;
+    batch.in = in;
+    batch.out = out;
+    batch.lines = 0;
+    batch.solved = 0;
+
+    vector<thread> workers;
+    int i;
+    for (i = 0; i < threads; i++)
+        workers.push_back(thread(solveLines, &batch));
+    for (i = 0; i < threads; i++)
+        workers[i].join();
+
+    return batch.solved;
+};
@@ -0,0 +1,39 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Batch solving header
+  */
+
+#ifndef BATCH_HH
+#define BATCH_HH
+
+#include <stdio.h>
+#include <string>
+#include <list>
+#include "rubik.hh"
+#include "idastar.hh"
+
+/*
+ * Cubes are written one per line, in either of two ways:
+ *
+ * - A scramble: moves from the goal, separated by spaces. A move is a face
+ *   (L left, R right, U top, D bottom, F front, B back) followed by
+ *   nothing, 2 or ' for the moves print_solution calls 90 degrees
+ *   clockwise, 180 degrees and 90 degrees counter clockwise.
+ * - A configuration: 20 pairs of numbers, the position and orientation of
+ *   every cubie as Rubik::print shows them.
+ *
+ * Solutions are written with the same moves
+ */
+
+extern bool parseCube(const char *,Rubik *,std::string *);
+
+extern std::string formatMoves(const std::list<char> &);
+
+extern long solveBatch(const Solver &,FILE *,FILE *,int);
+
+#endif
@@ -0,0 +1,521 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Benchmark: solves the cubes of a corpus, writes what each one took and
+  * compares the results with those of an earlier run
+  *
+  * Usage: ./bench [-8 | -4 | -2] [-s lookups] [-j threads] [-d depth]
+  *                [-o results] [-c baseline [-t percent]] [corpus]
+  *     -8, -4, -2, -s, -j : as in ./main (-j splits the search of every
+  *          cube among that many threads)
+  *     -d : only solve the cubes of the corpus up to that optimal depth
+  *     -o : write the results to a file instead of the standard output
+  *     -c : compare the results with those of an earlier run (a file
+  *          written by -o with the same configuration), and take as worse
+  *          every cube that is slower by more than the threshold or, with
+  *          one thread, expands more nodes
+  *     -t : threshold of -c in percent (default 10)
+  *     corpus : cubes to solve (default corpus.txt)
+  *
+  * The results are written as JSON, one cube per line (see writeResults).
+  * The exit status is 2 when a cube isn't solved optimally or is worse than
+  * in the baseline
+  */
+
+#include <climits>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include "rubik.hh"
+#include "rubikpd.hh"
+#include "idastar.hh"
+#include "batch.hh"
+
+using namespace std;
+
+/*
+ * Cube of the corpus and what solving it took
+ */
+typedef struct Instance Instance;
+
+struct Instance {
+    long line;             //Line of the corpus
+    int depth;             //Optimal depth given by the corpus
+    Rubik cube;
+    int length;            //Length of the solution found
+    bool solved;           //Whether the solution takes the cube to the goal
+    long nodes;
+    double ms;
+    long rss;              //Peak resident memory while solving (KB)
+    bool compared;         //Whether the baseline has this cube
+    long baseNodes;        //Nodes and milliseconds of the baseline
+    double baseMs;
+    bool regression;
+};
+
+/*
+ * What a run measured: runs are only compared with runs of the same
+ * configuration
+ */
+typedef struct Configuration Configuration;
+
+struct Configuration {
+    int bits;              //Bits per entry asked for (0 for the files)
+    int edges;             //Edges of the edge patterns
+    int lookups;           //Lookups per node, the corners one included
+    int threads;           //Threads per cube
+};
+
+/*
+ * Differences of less than this many milliseconds are taken as noise
+ */
+#define NOISE_MS 5.0
+
+
+/**
+  * Reads the cubes of a corpus. Lines hold the optimal depth of a cube and
+  * a scramble that makes it (see batch.hh), and a line "version N" gives
+  * the version of the corpus
+  * @param 'name'      : name of the corpus
+  * @param 'depth'     : largest depth read
+  * @param 'instances' : where the cubes are stored
+  * @return The version of the corpus, or -1 if it can't be read
+  */
+
+static int readCorpus(const char *name, int depth,
+                      vector<Instance> *instances) {
+    FILE *fp = fopen(name, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "Can't open %s\n", name);
+        return -1;
+    }
+
+    int version = 0;
+    long number = 0;
+    char line[1024];
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        number++;
+        char *text = line;
+        while (isspace(*text))
+            text++;
+        if ((*text == '\0') || (*text == '#'))
+            continue;
+
+        if (sscanf(text, "version %d", &version) == 1)
+            continue;
+
+        Instance instance;
+        instance.line = number;
+        instance.compared = false;
+        instance.regression = false;
+        char *end;
+        instance.depth = strtol(text, &end, 10);
+        string error;
+        if ((end == text) || !parseCube(end, &instance.cube, &error)) {
+            fprintf(stderr, "%s:%ld: %s\n", name, number,
+                    (end == text) ? "no depth" : error.c_str());
+            fclose(fp);
+            return -1;
+        }
+
+        if (instance.depth <= depth)
+            instances->push_back(instance);
+    }
+
+    fclose(fp);
+    return version;
+};
+
+
+/**
+  * Reads the results of an earlier run and keeps the nodes and
+  * milliseconds of every cube it shares with this one
+  * @param 'name'      : file written by -o
+  * @param 'version'   : version of the corpus of this run
+  * @param 'config'    : configuration of this run
+  * @param 'instances' : cubes of this run
+  * @return True if the file holds results of the same corpus and
+  *         configuration
+  */
+
+static bool readBaseline(const char *name, int version,
+                         const Configuration &config,
+                         vector<Instance> *instances) {
+    FILE *fp = fopen(name, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "Can't open %s\n", name);
+        return false;
+    }
+
+    int base = -1;
+    Configuration other;
+    other.bits = -1;
+    char line[1024];
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        long number, nodes;
+        int depth, length;
+        double ms;
+        char *text = line;
+        while (isspace(*text))
+            text++;
+
+        if (sscanf(text, "\"corpus_version\": %d", &base) == 1)
+            continue;
+        Configuration read;
+        if (sscanf(text, "\"configuration\": {\"bits\": %d, \"edges\": %d, "
+                   "\"lookups_per_node\": %d, \"threads\": %d}", &read.bits,
+                   &read.edges, &read.lookups, &read.threads) == 4) {
+            other = read;
+            continue;
+        }
+        if (sscanf(text, "{\"line\": %ld, \"depth\": %d, \"length\": %d, "
+                   "\"solved\": %*[a-z], \"nodes\": %ld, \"ms\": %lf",
+                   &number, &depth, &length, &nodes, &ms) != 5)
+            continue;
+
+        size_t i;
+        for (i = 0; i < instances->size(); i++) {
+            Instance &instance = (*instances)[i];
+            if ((instance.line == number) && (instance.depth == depth)) {
+                instance.compared = true;
+                instance.baseNodes = nodes;
+                instance.baseMs = ms;
+            }
+        }
+    }
+    fclose(fp);
+
+    if (base != version) {
+        fprintf(stderr, "%s has results of version %d of the corpus, "
+                "not %d\n", name, base, version);
+        return false;
+    }
+
+    if ((other.bits != config.bits) || (other.edges != config.edges) ||
+        (other.lookups != config.lookups) ||
+        (other.threads != config.threads)) {
+        if (other.bits < 0)
+            fprintf(stderr, "%s has no configuration\n", name);
+        else
+            fprintf(stderr, "%s was run with bits %d, %d edges, %d lookups "
+                    "and %d threads\n", name, other.bits, other.edges,
+                    other.lookups, other.threads);
+        return false;
+    }
+
+    return true;
+};
+
+
+/**
+  * Forgets the peak resident memory of the process, so that the next
+  * peak read belongs to what comes after (Linux only)
+  */
+
+static void resetPeakMemory() {
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if (fp == NULL)
+        return;
+    fputs("5", fp);
+    fclose(fp);
+};
+
+
+/**
+  * Reads the peak resident memory of the process since the last
+  * resetPeakMemory
+  * @return Peak resident memory in KB, or 0 if it can't be read
+  */
+
+static long peakMemory() {
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (fp == NULL)
+        return 0;
+
+    long kb = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf(line, "VmHWM: %ld kB", &kb) == 1)
+            break;
+    }
+    fclose(fp);
+    return kb;
+};
+
+
+/**
+  * Solves a cube of the corpus and checks the solution
+  * @param 'solver'   : solver
+  * @param 'instance' : cube, where the results are stored
+  */
+
+static void solveInstance(const Solver &solver, Instance *instance) {
+    resetPeakMemory();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Solution sol = solver.solve(instance->cube);
+    chrono::duration<double, milli> time = chrono::steady_clock::now() - start;
+
+    instance->nodes = sol.nodes;
+    instance->ms = time.count();
+    instance->rss = peakMemory();
+    instance->length = -1;
+    instance->solved = false;
+    if (sol.cost == INT_MAX)
+        return;
+
+    //The path keeps the last move first
+    Rubik cube = instance->cube;
+    list<char>::reverse_iterator it;
+    for (it = sol.path.rbegin(); it != sol.path.rend(); ++it) {
+        if (*it == '\x00')       //Root node
+            continue;
+        cube.turn((*it - 'A') / 3, (*it - 'A') % 3 + 1);
+    }
+    instance->length = sol.cost;
+    instance->solved = cube.isSolved();
+};
+
+
+/**
+  * Says if a cube got worse than in the baseline: it isn't solved
+  * optimally, it expands more nodes, or it is slower by more than the
+  * threshold (and by more than the noise). Threads steal subtrees in no
+  * fixed order, so the nodes only repeat from run to run with one thread
+  * @param 'instance'  : cube solved
+  * @param 'threshold' : percent of time allowed over the baseline
+  * @param 'threads'   : threads per cube, in this run and the baseline
+  * @return True if the cube got worse
+  */
+
+static bool isRegression(const Instance &instance, double threshold,
+                         int threads) {
+    if (!instance.solved || (instance.length != instance.depth))
+        return true;
+    if (!instance.compared)
+        return false;
+
+    return ((threads == 1) && (instance.nodes > instance.baseNodes)) ||
+           ((instance.ms > instance.baseMs * (1 + threshold / 100)) &&
+            (instance.ms - instance.baseMs > NOISE_MS));
+};
+
+
+/**
+  * Nodes expanded per second
+  * @param 'nodes' : nodes expanded
+  * @param 'ms'    : milliseconds taken
+  * @return Nodes per second (0 when no time was measured)
+  */
+
+static long rate(long nodes, double ms) {
+    if (ms <= 0)
+        return 0;
+    return (long) (nodes / ms * 1000);
+};
+
+
+/**
+  * Writes the results as JSON: the configuration, every cube on a line of
+  * its own (so that -c can read them back), a summary of every depth and
+  * a summary of the run. With a baseline, every cube and the summary have
+  * the nodes and milliseconds of the baseline too
+  * @param 'out'       : file
+  * @param 'version'   : version of the corpus
+  * @param 'config'    : configuration of the run
+  * @param 'loadMs'    : milliseconds taken to load the tables and build
+  *                      the ones built when first needed
+  * @param 'loadRss'   : resident memory after loading the tables (KB)
+  * @param 'instances' : cubes solved
+  * @param 'baseline'  : whether they were compared with a baseline
+  */
+
+static void writeResults(FILE *out, int version, const Configuration &config,
+                         double loadMs, long loadRss,
+                         const vector<Instance> &instances, bool baseline) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"corpus_version\": %d,\n", version);
+    fprintf(out, "  \"configuration\": {\"bits\": %d, \"edges\": %d, "
+            "\"lookups_per_node\": %d, \"threads\": %d},\n", config.bits,
+            config.edges, config.lookups, config.threads);
+    fprintf(out, "  \"load\": {\"ms\": %.1f, \"rss_kb\": %ld},\n", loadMs,
+            loadRss);
+
+    fprintf(out, "  \"instances\": [\n");
+    size_t i;
+    for (i = 0; i < instances.size(); i++) {
+        const Instance &in = instances[i];
+        fprintf(out, "    {\"line\": %ld, \"depth\": %d, \"length\": %d, "
+                "\"solved\": %s, \"nodes\": %ld, \"ms\": %.1f, "
+                "\"nodes_per_second\": %ld, \"peak_rss_kb\": %ld", in.line,
+                in.depth, in.length, in.solved ? "true" : "false", in.nodes,
+                in.ms, rate(in.nodes, in.ms), in.rss);
+        if (in.compared)
+            fprintf(out, ", \"baseline_nodes\": %ld, \"baseline_ms\": %.1f",
+                    in.baseNodes, in.baseMs);
+        if (baseline)
+            fprintf(out, ", \"regression\": %s",
+                    in.regression ? "true" : "false");
+        fprintf(out, "}%s\n", (i + 1 < instances.size()) ? "," : "");
+    }
+    fprintf(out, "  ],\n");
+
+    //Instances come from the corpus grouped by depth
+    fprintf(out, "  \"depths\": [\n");
+    long nodes = 0;
+    long baseNodes = 0;
+    long rss = loadRss;
+    double ms = 0;
+    double baseMs = 0;
+    int wrong = 0;
+    int regressions = 0;
+    i = 0;
+    while (i < instances.size()) {
+        int depth = instances[i].depth;
+        long n = 0;
+        double t = 0;
+        int count = 0;
+        for (; (i < instances.size()) && (instances[i].depth == depth); i++) {
+            const Instance &in = instances[i];
+            n += in.nodes;
+            t += in.ms;
+            count++;
+            rss = max(rss, in.rss);
+            if (!in.solved || (in.length != in.depth))
+                wrong++;
+            if (in.regression)
+                regressions++;
+            if (in.compared) {
+                baseNodes += in.baseNodes;
+                baseMs += in.baseMs;
+            }
+        }
+        nodes += n;
+        ms += t;
+        fprintf(out, "    {\"depth\": %d, \"instances\": %d, \"nodes\": %ld, "
+                "\"ms\": %.1f, \"mean_ms\": %.1f, \"nodes_per_second\": %ld}"
+                "%s\n", depth, count, n, t, t / count, rate(n, t),
+                (i < instances.size()) ? "," : "");
+    }
+    fprintf(out, "  ],\n");
+
+    fprintf(out, "  \"summary\": {\"instances\": %d, \"not_optimal\": %d, "
+            "\"nodes\": %ld, \"ms\": %.1f, \"nodes_per_second\": %ld, "
+            "\"peak_rss_kb\": %ld", (int) instances.size(), wrong, nodes, ms,
+            rate(nodes, ms), rss);
+    if (baseline)
+        fprintf(out, ", \"baseline_nodes\": %ld, \"baseline_ms\": %.1f, "
+                "\"regressions\": %d", baseNodes, baseMs, regressions);
+    fprintf(out, "}\n}\n");
+};
+
+
+int main(int argc, char **argv) {
+    int bits = 0;
+    int lookups = 2;
+    int threads = 1;
+    int depth = INT_MAX;
+    const char *output = NULL;
+    const char *baseline = NULL;
+    double threshold = 10;
+    const char *corpus = "corpus.txt";
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-2") == 0)
+            bits = 2;
+        else if (strcmp(argv[i], "-4") == 0)
+            bits = 4;
+        else if (strcmp(argv[i], "-8") == 0)
+            bits = 8;
+        else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+            lookups = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc))
+            threads = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc))
+            depth = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))
+            output = argv[++i];
+        else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc))
+            baseline = argv[++i];
+        else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc))
+            threshold = atof(argv[++i]);
+        else if ((argv[i][0] != '-') && (i + 1 == argc))
+            corpus = argv[i];
+        else {
+            printf("Usage: %s [-8 | -4 | -2] [-s lookups] [-j threads] "
+                   "[-d depth] [-o results] [-c baseline [-t percent]] "
+                   "[corpus]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    vector<Instance> instances;
+    int version = readCorpus(corpus, depth, &instances);
+    if (version < 0)
+        return 1;
+
+    resetPeakMemory();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    shared_ptr<Rubikpd> rpd = make_shared<Rubikpd>();
+    if (!rpd->initializeAllWithFiles(bits)) {
+        fprintf(stderr, "Run ./pdb to create the pattern databases\n");
+        return 1;
+    }
+    rpd->setLookups(lookups);
+    Solver solver(rpd, threads);
+    solver.warmUp();
+    chrono::duration<double, milli> load = chrono::steady_clock::now() - start;
+    long loadRss = peakMemory();
+
+    //The edges are only known once the tables are loaded
+    Configuration config;
+    config.bits = bits;
+    config.edges = rpd->getEdges();
+    config.lookups = rpd->getLookups();
+    config.threads = max(threads, 1);
+    if ((baseline != NULL) &&
+        !readBaseline(baseline, version, config, &instances))
+        return 1;
+
+    int regressions = 0;
+    size_t k;
+    for (k = 0; k < instances.size(); k++) {
+        Instance &in = instances[k];
+        solveInstance(solver, &in);
+        in.regression = isRegression(in, threshold, config.threads);
+        if (in.regression)
+            regressions++;
+
+        fprintf(stderr, "line %ld: depth %d, length %d, %ld nodes, %.1f ms",
+                in.line, in.depth, in.length, in.nodes, in.ms);
+        if (in.compared)
+            fprintf(stderr, " (baseline %ld nodes, %.1f ms)", in.baseNodes,
+                    in.baseMs);
+        fprintf(stderr, "%s\n", in.regression ? " REGRESSION" : "");
+    }
+
+    FILE *out = stdout;
+    if (output != NULL)
+        out = fopen(output, "w");
+    if (out == NULL) {
+        fprintf(stderr, "Can't create %s\n", output);
+        return 1;
+    }
+    writeResults(out, version, config, load.count(), loadRss, instances,
+                 baseline != NULL);
+    if (out != stdout)
+        fclose(out);
+
+    if (regressions > 0) {
+        fprintf(stderr, "Cubes worse than the baseline: %d\n", regressions);
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Converts the old corners.bin and edges1.bin (one int per entry) into
+  * corners.pdb and edges1.pdb. The full corners table is still read when
+  * there is no cornersym.pdb, and edges2 is looked up in edges1, so the
+  * old edges2.bin is not converted. It also checks the .pdb files
+  * against their checksums
+  *
+  * Usage: ./pdbconvert [-8 | -4 | -2 | -v]
+  *     -4 : two entries per byte (default)
+  *     -8 : one entry per byte
+  *     -2 : four entries per byte, costs kept mod 3
+  *     -v : checks the .pdb files that are there against their checksums:
+  *          cornersym.pdb and edges1.pdb, edges1_7.pdb and edges1_8.pdb as
+  *          ./pdb writes them, and corners.pdb
+  */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "pdbtable.hh"
+#include "movetables.hh"
+#include "symmetry.hh"
+
+
+/**
+  * Checks a .pdb file against its checksum, if the file is there
+  * @param 'name'    : name of the file
+  * @param 'kind'    : PDB_CORNERS, PDB_CORNERS_SYM or PDB_EDGES1
+  * @param 'entries' : number of entries of the table
+  * @param 'found'   : counter of the files that are there
+  * @return False if the file is there and can't be read or doesn't match
+  *         its checksum
+  */
+
+static bool verifyFile(const char *name, int kind, long entries, int *found) {
+    if (access(name, F_OK) != 0)
+        return true;
+    (*found)++;
+
+    PdbTable table;
+    if (!table.mapFile(name, kind, entries))
+        return false;
+    bool ok = table.verify();
+    printf("%s: %s\n", name, ok ? "ok" : "checksum mismatch");
+    return ok;
+};
+
+
+/**
+  * Checks every .pdb file that ./pdb, ./pdbconvert or an older version
+  * wrote
+  * @return 0 if every file that is there is right, 1 in any other case
+  */
+
+static int verifyFiles() {
+    int found = 0;
+    bool ok = verifyFile("corners.pdb", PDB_CORNERS, 264539520, &found);
+
+    //The table only needs the classes of corners when the file is there
+    if (access("cornersym.pdb", F_OK) == 0)
+        ok = verifyFile("cornersym.pdb", PDB_CORNERS_SYM,
+                        Symmetries::tables().cornersEntries(), &found) && ok;
+
+    int k;
+    for (k = 6; k <= EDGES_MAX; k++) {
+        char name[16];
+        if (k == 6)
+            sprintf(name, "edges1.pdb");
+        else
+            sprintf(name, "edges1_%d.pdb", k);
+        long entries = (long) MoveTables::edgesPositions(k) << k;
+        ok = verifyFile(name, PDB_EDGES1, entries, &found) && ok;
+    }
+
+    if (found == 0) {
+        printf("There are no .pdb files to check\n");
+        return 1;
+    }
+    return ok ? 0 : 1;
+};
+
+
+int main(int argc, char **argv) {
+    const char *bins[2] = {"corners.bin", "edges1.bin"};
+    const char *pdbs[2] = {"corners.pdb", "edges1.pdb"};
+    int kinds[2] = {PDB_CORNERS, PDB_EDGES1};
+    long entries[2] = {264539520, 42577920};
+
+    int bits = 4;
+    if (argc > 1) {
+        if (strcmp(argv[1], "-8") == 0)
+            bits = 8;
+        else if (strcmp(argv[1], "-2") == 0)
+            bits = 2;
+        else if (strcmp(argv[1], "-v") == 0)
+            return verifyFiles();
+        else if (strcmp(argv[1], "-4") != 0) {
+            printf("Usage: %s [-8 | -4 | -2 | -v]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int status = 0;
+    int i;
+    for (i = 0; i < 2; i++) {
+        PdbTable table;
+        printf("Converting %s into %s\n", bins[i], pdbs[i]);
+        if ((!table.mapFile(bins[i], kinds[i], entries[i])) ||
+            (!table.writeFile(pdbs[i], kinds[i], bits)))
+            status = 1;
+    }
+
+    return status;
+}
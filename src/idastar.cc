@@ -11,82 +11,629 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <climits>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
 #include "idastar.hh"
 #include "rubiknode.hh"
 #include "rubikpd.hh"
 #include "rubik.hh"
+#include "movetables.hh"
+#include "movepruning.hh"
 #include "utils.hh"
 
 using namespace std;
 
-Rubikpd rpd;
+/*
+ * Subtree searched by a worker of the parallel IDA*: a node at the split
+ * depth, with its indexes and heuristic
+ */
+typedef struct Subproblem Subproblem;
+
+struct Subproblem {
+    RubikNode node;
+    long index[PDB_LOOKUPS];
+    int h[PDB_LOOKUPS];
+    int hcost;
+};
+
+/*
+ * Node on the path searched by IDdfs, and what is known about its children
+ */
+typedef struct Frame Frame;
+
+struct Frame {
+    Rubik *state;              //In the frame of the parent
+    int move;                  //Move that made the node, or -1
+    int pruning;               //State of the move pruning automaton
+    int gcost;
+    int hcost;
+    const long *index;         //In the frame of the parent
+    const int *h;              //In the frame of the parent
+    const int *moves;          //Moves that make the children
+    int number;                //Number of children
+    int next;                  //Next child to go down
+    int newlimit;              //Smallest cost above the limit so far
+    Rubik children[MOVES];     //Successors, by move
+    long indexes[MOVES][PDB_LOOKUPS];    //By child
+    int values[MOVES][PDB_LOOKUPS];
+    int hchild[MOVES];
+};
+
+/*
+ * Subtrees of a worker. The worker takes them from the front, and workers
+ * with nothing left to do steal them from the back
+ */
+typedef struct WorkQueue WorkQueue;
+
+struct WorkQueue {
+    mutex lock;
+    deque<Subproblem *> tasks;
+};
+
+/*
+ * State shared by the workers of one iteration of the parallel IDA*
+ */
+typedef struct Iteration Iteration;
+
+struct Iteration {
+    const Rubikpd *rpd;
+    int limit;
+    int threads;
+    WorkQueue *queues;         //One for every worker
+    atomic<bool> stop;         //Set when a solution is found or on abort
+    bool found;                //Whether a solution was found
+    const atomic<bool> *abort; //Flag set from outside to give up (or NULL)
+    atomic<long> nodes;
+    mutex lock;                //Guards solution and newlimit
+    Solution solution;
+    int newlimit;
+};
 
 
 /**
-  * Bounded DFS
-  * @param 'node'  :  A RubikNode element
-  * @param 'cost'  :  Cost of the path
+  * Makes an empty solution: no path found, no nodes expanded and no
+  * heuristic known
   */
 
-Solution IDdfs(RubikNode node, int limit) {
-    int gcost = node.getCost();
-    int hcost = rpd.heuristic(node.getState());
+Solution::Solution() {
+    this->cost = INT_MAX;
+    this->nodes = 0;
+    this->h = -1;
+};
+
+
+/**
+  * Makes a solver that uses the pattern databases behind 'pdb'
+  * @param 'pdb' : shared handle to the pattern databases
+  */
+
+Solver::Solver(PdbHandle pdb) {
+    this->pdb = pdb;
+    this->threads = 1;
+};
+
+
+/**
+  * Makes a solver that splits every search among several threads
+  * @param 'pdb'     : shared handle to the pattern databases
+  * @param 'threads' : number of threads of every search
+  */
+
+Solver::Solver(PdbHandle pdb, int threads) {
+    this->pdb = pdb;
+    this->threads = max(threads, 1);
+};
+
+
+/**
+  * Solves a Rubik's cube. It only reads the pattern databases, so it can
+  * be called from several threads at once
+  * @param 'problem' : Rubik's cube to be solved
+  * @return Optimal solution
+  */
+
+Solution Solver::solve(Rubik problem) const {
+    return this->solve(problem, NULL);
+};
+
+
+/**
+  * Solves a Rubik's cube unless it is stopped first
+  * @param 'problem' : Rubik's cube to be solved
+  * @param 'stop'    : flag that another thread sets to give up (or NULL)
+  * @return Optimal solution, or no solution if it was stopped
+  */
+
+Solution Solver::solve(Rubik problem, const atomic<bool> *stop) const {
+    if (this->threads > 1)
+        return ParallelIDAstar(problem, *this->pdb, this->threads, stop);
+    return IDAstar(problem, *this->pdb, stop);
+};
+
 
+/**
+  * Reads the pages of mapped tables and builds the tables built the first
+  * time they are needed (symmetries, move pruning) by solving a cube one
+  * move away, so that the first cube solved doesn't pay for them
+  */
+
+void Solver::warmUp() const {
+    this->pdb->prefetch();
+    Rubik cube;
+    cube.transformToGoal();
+    cube.turn(0, 1);
+    this->solve(cube);
+};
+
+
+/**
+  * Returns the handle to the pattern databases
+  * @return Shared handle to the pattern databases
+  */
+
+PdbHandle Solver::getPdb() const {
+    return this->pdb;
+};
+
+
+/**
+  * Bounded DFS. Every node carries its indexes in the pattern databases,
+  * and the indexes of its children come from the move tables, so no node
+  * is ranked.
+  *
+  * @section Description
+  *
+  * Dual lookups make the heuristic inconsistent: a child can be more than
+  * one move closer than its parent says. Bidirectional pathmax (BPMX) fixes
+  * that: every child is looked up before going down, a child's value minus
+  * one raises the node's value (and may cut the node before going down),
+  * the node's value minus one raises each child's, and values learned
+  * below a child come back up the same way.
+  *
+  * The search doesn't recurse: the path is kept in a stack of frames, one
+  * for every depth, so nothing is allocated until a solution is found
+  * @param 'rpd'    :  Pattern databases
+  * @param 'node'   :  A RubikNode element
+  * @param 'limit'  :  Largest cost of the paths explored (at most
+  *                    MAX_DEPTH)
+  * @param 'index'  :  Index of the node in each pattern database
+  * @param 'h'      :  Exact cost of the node in each pattern database
+  * @param 'hcost'  :  Heuristic of the node
+  * @param 'nodes'  :  Counter of expanded nodes
+  * @param 'stop'   :  Flag set when another thread finds a solution (or
+  *                    NULL)
+  * @param 'abort'  :  Flag set from outside to give up (or NULL)
+  */
+
+Solution IDdfs(const Rubikpd &rpd, RubikNode node, int limit,
+               const long *index, const int *h, int hcost, long *nodes,
+               const atomic<bool> *stop, const atomic<bool> *abort) {
+    Solution sol;
+    int gcost = node.getCost();
     if (gcost + hcost > limit) {
-        Solution sol;
         sol.cost = gcost + hcost;
+        sol.h = hcost;
         return sol;
     }
 
-    if (node.isGoal()) {
-        Solution sol;
-        sol.path = node.extractSolution();
-        sol.cost = gcost;
-        return sol;
-    }
+    Frame stack[MAX_DEPTH + 1];
+    Rubik root = node.getState();
+    stack[0].state = &root;
+    stack[0].move = node.getMove();
+    stack[0].pruning = node.getPruning();
+    stack[0].gcost = gcost;
+    stack[0].hcost = hcost;
+    stack[0].index = index;
+    stack[0].h = h;
 
-    int newlimit = INT_MAX;
-    int number_children = node.numberOfChildren();
+    const MovePruning &pruning = MovePruning::tables();
+    bool dual = rpd.hasDual();
+    long entries[MOVES][PDB_LOOKUPS];       //Of the children
+    long dualEntries[MOVES][PDB_LOOKUPS];   //Of the inverses of children
+    int dualChildren[MOVES];                //Children of those inverses
+    long inverseIndex[PDB_LOOKUPS];
+    int depth = 0;
+    bool entering = true;    //Whether the top frame was just pushed
+    int cost = 0;            //Bound returned by the last frame left
+    int back = 0;            //Heuristic of the last frame left
     int i;
-    for (i = 0; i < number_children; i++) {
-        RubikNode node1 = node.getChild(i);
-        Solution sol = IDdfs(node1, limit);
-        if (! sol.path.empty()) 
-            return sol;
+    while (true) {
+        Frame *f = &stack[depth];
+        bool leave = false;
 
-        newlimit = min(sol.cost, newlimit);
-    }
+        if (entering) {
+            //The search is over, this subtree is left without a bound
+            if (((stop != NULL) && stop->load(memory_order_relaxed)) ||
+                ((abort != NULL) && abort->load(memory_order_relaxed))) {
+                cost = INT_MAX;
+                back = f->hcost;
+                leave = true;
+            }
+            else if (f->state->isSolved()) {
+                for (i = depth; i > 0; i--)
+                    sol.path.push_back('A' + stack[i].move);
+                sol.path.splice(sol.path.end(), node.extractSolution());
+                sol.cost = f->gcost;
+                return sol;
+            }
+            else {
+                (*nodes)++;
+                f->number = pruning.moves(f->pruning, &f->moves);
+                f->state->expand(f->children);
 
-    Solution sol;
+                //The entries of every child are asked for before any of
+                //them is looked up, so the misses of the siblings overlap
+                for (i = 0; i < f->number; i++) {
+                    rpd.moveIndexes(f->index, f->moves[i], f->indexes[i]);
+                    rpd.entries(f->indexes[i], entries[i]);
+                    rpd.prefetch(entries[i]);
+                }
 
-    sol.cost = newlimit;
+                //The inverse is only ranked for children that aren't cut
+                //already, and looked up once every one of them is ranked
+                int inverses = 0;
+                for (i = 0; i < f->number; i++) {
+                    f->hchild[i] = rpd.lookup(entries[i], f->h, f->values[i]);
+                    if (dual && (f->gcost + 1 + f->hchild[i] <= limit)) {
+                        Rubik inverse = f->children[f->moves[i]].inverse();
+                        rpd.indexes(inverse, inverseIndex);
+                        rpd.entries(inverseIndex, dualEntries[inverses]);
+                        rpd.prefetch(dualEntries[inverses]);
+                        dualChildren[inverses++] = i;
+                    }
+                }
 
-    return sol;
-    
+                int k;
+                for (k = 0; k < inverses; k++) {
+                    i = dualChildren[k];
+                    f->hchild[i] = max(f->hchild[i],
+                                       rpd.lookupDual(dualEntries[k]));
+                }
+                for (i = 0; i < f->number; i++)
+                    f->hcost = max(f->hcost, f->hchild[i] - 1);
+                f->next = 0;
+                f->newlimit = INT_MAX;
+
+                if (f->gcost + f->hcost > limit) {
+                    cost = f->gcost + f->hcost;
+                    back = f->hcost;
+                    leave = true;
+                }
+            }
+        }
+        else {
+            f->newlimit = min(cost, f->newlimit);
+
+            //The rest of the children are at least as far as this bound
+            //says
+            f->hcost = max(f->hcost, back - 1);
+            if (f->gcost + f->hcost > limit) {
+                cost = min(f->gcost + f->hcost, f->newlimit);
+                back = f->hcost;
+                leave = true;
+            }
+        }
+
+        if (!leave && (f->next == f->number)) {
+            cost = f->newlimit;
+            back = f->hcost;
+            leave = true;
+        }
+
+        if (leave) {
+            if (depth == 0) {
+                sol.cost = cost;
+                sol.h = back;
+                return sol;
+            }
+            depth--;
+            entering = false;
+            continue;
+        }
+
+        //A child that is cut comes back at once, without a frame
+        i = f->next++;
+        int hc = max(f->hchild[i], f->hcost - 1);
+        if (f->gcost + 1 + hc > limit) {
+            cost = f->gcost + 1 + hc;
+            back = hc;
+            entering = false;
+            continue;
+        }
+
+        Frame *child = &stack[depth + 1];
+        child->state = &f->children[f->moves[i]];
+        child->move = f->moves[i];
+        child->pruning = pruning.next(f->pruning, f->moves[i]);
+        child->gcost = f->gcost + 1;
+        child->hcost = hc;
+        child->index = f->indexes[i];
+        child->h = f->values[i];
+        depth++;
+        entering = true;
+    }
 };
 
 
 /**
   * IDA* algorithm
   * @param 'cube' : problem to be solved
-  * @return Optimal solution      
+  * @param 'rpd'  : pattern databases
+  * @param 'stop' : flag that another thread sets to give up (or NULL)
+  * @return Optimal solution, or no solution if it was stopped or a table
+  *         that keeps costs mod 3 is corrupt
   */
 
-Solution IDAstar(Rubik problem, Rubikpd pdb) {
-    rpd = pdb;
+Solution IDAstar(Rubik problem, const Rubikpd &rpd,
+                 const atomic<bool> *stop) {
     RubikNode node;
     node.makeRootNode(problem);
-    int limit = rpd.heuristic(node.getState());
+    long index[PDB_LOOKUPS];
+    rpd.indexes(node.getState(), index);
+
+    int h[PDB_LOOKUPS];
+    int hcost = rpd.values(index, h);
+    if (hcost < 0)
+        return Solution();
+    if (rpd.hasDual())
+        hcost = max(hcost, rpd.dual(problem));
+    int limit = hcost;
+    long nodes = 0;
 
-    while (limit < INT_MAX) {
-        Solution sol = IDdfs(node, limit);
-        if  (! sol.path.empty()) 
+    while (limit <= MAX_DEPTH) {
+        Solution sol = IDdfs(rpd, node, limit, index, h, hcost, &nodes, NULL,
+                             stop);
+        if  (! sol.path.empty()) {
+            sol.nodes = nodes;
             return sol;
+        }
+        limit  = sol.cost;
+    }
+
+    Solution fail;
+    fail.cost = INT_MAX;
+    fail.nodes = nodes;
+
+    return fail;
+};
+
+
+/**
+  * Takes the next subtree of a worker, or steals one from another worker
+  * @param 'it' : iteration
+  * @param 'id' : number of the worker
+  * @return Subtree to search, or NULL when there are none left
+  */
+
+static Subproblem *takeSubproblem(Iteration *it, int id) {
+    int k;
+    for (k = 0; k < it->threads; k++) {
+        WorkQueue *queue = &it->queues[(id + k) % it->threads];
+        lock_guard<mutex> guard(queue->lock);
+        if (queue->tasks.empty())
+            continue;
+
+        Subproblem *task;
+        if (k == 0) {
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+        }
+        else {
+            task = queue->tasks.back();
+            queue->tasks.pop_back();
+        }
+        return task;
+    }
+
+    return NULL;
+};
+
+
+/**
+  * Worker of the parallel IDA*. Searches subtrees until there are none
+  * left or a solution is found
+  * @param 'it' : iteration
+  * @param 'id' : number of the worker
+  */
+
+static void searchSubproblems(Iteration *it, int id) {
+    long nodes = 0;
+    Subproblem *task;
+    while (!it->stop && ((task = takeSubproblem(it, id)) != NULL)) {
+        Solution sol = IDdfs(*it->rpd, task->node, it->limit, task->index,
+                             task->h, task->hcost, &nodes, &it->stop,
+                             it->abort);
+
+        lock_guard<mutex> guard(it->lock);
+        if (! sol.path.empty()) {
+            //Every solution found under this limit is optimal
+            if (!it->stop) {
+                it->solution = sol;
+                it->found = true;
+                it->stop = true;
+            }
+        }
+        else if ((it->abort != NULL) && *it->abort)
+            it->stop = true;    //The subtree was left without a bound
+        else
+            it->newlimit = min(sol.cost, it->newlimit);
+    }
+
+    it->nodes += nodes;
+};
+
+
+/**
+  * Expands a level of the tree, as IDdfs does, without going down
+  * @param 'rpd'      : pattern databases
+  * @param 'level'    : nodes of the level
+  * @param 'limit'    : largest cost of the paths explored
+  * @param 'next'     : where the children that aren't cut are stored
+  * @param 'sol'      : where the solution is stored, if a goal is found
+  * @param 'newlimit' : smallest cost above the limit seen so far
+  * @param 'nodes'    : counter of expanded nodes
+  */
+
+static void expandLevel(const Rubikpd &rpd, vector<Subproblem> &level,
+                        int limit, vector<Subproblem> &next, Solution *sol,
+                        int *newlimit, long *nodes) {
+    bool dual = rpd.hasDual();
+    int i, k;
+    for (k = 0; k < (int) level.size(); k++) {
+        Subproblem &task = level[k];
+        int gcost = task.node.getCost();
+        if (gcost + task.hcost > limit) {
+            *newlimit = min(gcost + task.hcost, *newlimit);
+            continue;
+        }
+
+        if (task.node.isGoal()) {
+            sol->path = task.node.extractSolution();
+            sol->cost = gcost;
+            return;
+        }
+
+        (*nodes)++;
+        int first = next.size();
+        int number_children = task.node.numberOfChildren();
+        int hcost = task.hcost;
+        for (i = 0; i < number_children; i++) {
+            Subproblem child;
+            child.node = task.node.getChild(i);
+            rpd.moveIndexes(task.index, child.node.getMove(), child.index);
+            child.hcost = rpd.values(child.index, task.h, child.h);
+            if (dual && (gcost + 1 + child.hcost <= limit))
+                child.hcost = max(child.hcost,
+                                  rpd.dual(child.node.getState()));
+            hcost = max(hcost, child.hcost - 1);
+            next.push_back(child);
+        }
+
+        if (gcost + hcost > limit) {
+            *newlimit = min(gcost + hcost, *newlimit);
+            next.resize(first);
+            continue;
+        }
+
+        for (i = first; i < (int) next.size(); i++)
+            next[i].hcost = max(next[i].hcost, hcost - 1);
+    }
+};
+
+
+/**
+  * One iteration of the parallel IDA*. The tree is expanded breadth first
+  * until there are SPLIT_TASKS subtrees for every thread, and the subtrees
+  * are searched by a pool of workers that steal from each other
+  * @param 'rpd'     : pattern databases
+  * @param 'root'    : root of the tree
+  * @param 'limit'   : largest cost of the paths explored
+  * @param 'threads' : number of workers
+  * @param 'nodes'   : counter of expanded nodes
+  * @param 'abort'   : flag that another thread sets to give up (or NULL)
+  * @return Solution, or the smallest cost above the limit
+  */
+
+static Solution parallelIDdfs(const Rubikpd &rpd, const Subproblem &root,
+                              int limit, int threads, long *nodes,
+                              const atomic<bool> *abort) {
+    Solution sol;
+    int newlimit = INT_MAX;
+
+    //Nodes point to their parents, so no level is moved or freed until
+    //the iteration is over
+    vector< vector<Subproblem> > levels;
+    levels.reserve(limit + 2);
+    levels.push_back(vector<Subproblem>(1, root));
+    while (levels.back().size() < (size_t) threads*SPLIT_TASKS) {
+        vector<Subproblem> next;
+        expandLevel(rpd, levels.back(), limit, next, &sol, &newlimit, nodes);
+        if (! sol.path.empty())
+            return sol;
+
+        if (next.empty()) {
+            sol.cost = newlimit;
+            return sol;
+        }
+        levels.push_back(vector<Subproblem>());
+        levels.back().swap(next);
+    }
+
+    Iteration it;
+    vector<WorkQueue> queues(threads);
+    it.rpd = &rpd;
+    it.limit = limit;
+    it.threads = threads;
+    it.queues = queues.data();
+    it.stop = false;
+    it.found = false;
+    it.abort = abort;
+    it.nodes = 0;
+    it.newlimit = newlimit;
+
+    //Neighbours have subtrees of about the same size, so they are dealt
+    vector<Subproblem> &tasks = levels.back();
+    int i;
+    for (i = 0; i < (int) tasks.size(); i++)
+        queues[i % threads].tasks.push_back(&tasks[i]);
+
+    vector<thread> workers;
+    for (i = 0; i < threads; i++)
+        workers.push_back(thread(searchSubproblems, &it, i));
+    for (i = 0; i < threads; i++)
+        workers[i].join();
+
+    *nodes += it.nodes;
+    if (it.found)
+        return it.solution;
+
+    sol.cost = it.newlimit;
+    if (it.stop)
+        sol.cost = INT_MAX;
+    return sol;
+};
+
+
+/**
+  * IDA* algorithm that splits every iteration among several threads. The
+  * iterations still go one after the other, so the first solution found
+  * is optimal, and every thread stops as soon as there is one
+  * @param 'cube'    : problem to be solved
+  * @param 'rpd'     : pattern databases
+  * @param 'threads' : number of threads
+  * @param 'stop'    : flag that another thread sets to give up (or NULL)
+  * @return Optimal solution, or no solution if it was stopped or a table
+  *         that keeps costs mod 3 is corrupt
+  */
+
+Solution ParallelIDAstar(Rubik problem, const Rubikpd &rpd, int threads,
+                         const atomic<bool> *stop) {
+    Subproblem root;
+    root.node.makeRootNode(problem);
+    rpd.indexes(root.node.getState(), root.index);
+    root.hcost = rpd.values(root.index, root.h);
+    if (root.hcost < 0)
+        return Solution();
+    if (rpd.hasDual())
+        root.hcost = max(root.hcost, rpd.dual(problem));
+    int limit = root.hcost;
+    long nodes = 0;
+
+    while (limit <= MAX_DEPTH) {
+        Solution sol = parallelIDdfs(rpd, root, limit, threads, &nodes,
+                                     stop);
+        if  (! sol.path.empty()) {
+            sol.nodes = nodes;
+            return sol;
+        }
         limit  = sol.cost;
     }
 
     Solution fail;
     fail.cost = INT_MAX;
+    fail.nodes = nodes;
 
     return fail;
 };
@@ -105,6 +652,7 @@ void print_solution(Solution solution) {
 
     int moves_maded = solution.path.size() - 1;
     printf("-------Total number of moves maded :  %d\n", moves_maded);
+    printf("-------Nodes expanded :  %ld\n", solution.nodes);
     for (list<char>::reverse_iterator it = solution.path.rbegin();
                               it != solution.path.rend();
                               ++it) {
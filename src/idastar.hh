@@ -15,6 +15,7 @@
 #include "rubik.hh"
 #include "rubikpd.hh"
 #include <list>
+#include <atomic>
 
 /*
  * Type of the solution
@@ -24,12 +25,54 @@ typedef struct Solution Solution;
 struct Solution {
     std::list<char> path;
     int cost;
+    long nodes;    //Nodes expanded to find it
+    int h;         //Heuristic of the node after pathmax (see IDdfs)
+
+    Solution();
 };
 
+/*
+ * No cube is more than 20 moves away from the goal, so no path searched is
+ * longer
+ */
+#define MAX_DEPTH 20
+
+/*
+ * Number of subtrees handed to every worker of the parallel IDA*, so that
+ * workers that run out of work can steal from the others
+ */
+#define SPLIT_TASKS 32
+
+/*
+ * Solver engine. It holds a shared handle to read-only pattern databases
+ * and keeps no state between solves, so many solves (on one solver or on
+ * several solvers sharing the handle) can run at once without copying
+ * the tables. A solver with more than one thread splits every search
+ * among them (see ParallelIDAstar)
+ */
+class Solver {
+    private:
+        PdbHandle pdb;
+        int threads;
+
+    public:
+        Solver(PdbHandle);
+        Solver(PdbHandle,int);
+        Solution solve(Rubik) const;
+        Solution solve(Rubik,const std::atomic<bool> *) const;
+        void warmUp() const;
+        PdbHandle getPdb() const;
+};
+
+
+extern Solution IDdfs(const Rubikpd &,RubikNode,int,const long *,const int *,
+                      int,long *,const std::atomic<bool> *,
+                      const std::atomic<bool> *);
 
-extern Solution IDdfs(RubikNode,int);
+extern Solution IDAstar(Rubik,const Rubikpd &,const std::atomic<bool> *);
 
-extern Solution IDAstar(Rubik,Rubikpd);
+extern Solution ParallelIDAstar(Rubik,const Rubikpd &,int,
+                                const std::atomic<bool> *);
 
 extern void print_solution(Solution);
 
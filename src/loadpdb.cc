@@ -1,6 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
 #include "rubikpd.hh"
 
-int main() {
+/*
+ * Usage: ./pdb [-8 | -4 | -2] [-q] [-j threads] [-e edges]
+ *     -4 : two entries per byte, in memory and in the files (default)
+ *     -8 : one entry per byte
+ *     -2 : four entries per byte, costs kept mod 3
+ *     -q : use an open queue instead of scanning the tables depth by depth
+ *     -j : number of threads that scan the tables, at least 1 (default: one
+ *          per core). With more than one the two tables are built at once
+ *          and the threads are split between them
+ *     -e : number of edges of edges1 and edges2: 6 (default), 7 or 8
+ */
+int main(int argc, char **argv) {
+    int bits = 4;
+    bool layered = true;
+    int edges = 6;
+    int threads = std::thread::hardware_concurrency();
+    if (threads < 1)
+        threads = 1;
+
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-8") == 0)
+            bits = 8;
+        else if (strcmp(argv[i], "-4") == 0)
+            bits = 4;
+        else if (strcmp(argv[i], "-2") == 0)
+            bits = 2;
+        else if (strcmp(argv[i], "-q") == 0)
+            layered = false;
+        else if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc) &&
+                 (atoi(argv[i + 1]) > 0))
+            threads = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-e") == 0) && (i + 1 < argc))
+            edges = atoi(argv[++i]);
+        else {
+            printf("Usage: %s [-8 | -4 | -2] [-q] [-j threads] [-e edges]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+
+    if ((edges < 6) || (edges > 8)) {
+        printf("Edge patterns have 6, 7 or 8 edges\n");
+        return 1;
+    }
+
     Rubikpd rpd;
-    rpd.initializeAll();
+    if (!rpd.initializeAll(bits, layered, threads, edges))
+        return 1;
 }
@@ -1,4 +1,5 @@
 #include <climits>
+#include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -7,14 +8,105 @@
 #include "rubiknode.hh"
 #include "rubikpd.hh"
 #include "idastar.hh"
+#include "batch.hh"
+#include "server.hh"
 #include "utils.hh"
 
 using namespace std;
 
-int main() {
+/*
+ * Usage: ./main [-8 | -4 | -2] [-m segment] [-s lookups] [-j threads]
+ *               [-b file] [-d socket [-q requests]]
+ *     -8, -4, -2 : keep the tables in memory with that many bits per entry
+ *                  (default: served from the mapped files)
+ *     -m : attach to the tables in a shared memory segment ("/rubik"), or
+ *          load them and publish them there when the segment is missing or
+ *          stale, so other processes can attach to them (see
+ *          Rubikpd::publish)
+ *     -s : number of lookups in edges1 for every node (default 2)
+ *     -j : number of threads that search every cube, or with -b and -d
+ *          the number of cubes solved at once (default 1)
+ *     -b : solve every cube of a file ("-" for the standard input) instead
+ *          of a random one, see batch.hh
+ *     -d : solve the cubes sent to a Unix socket until killed, see
+ *          server.hh
+ *     -q : most requests waiting for a worker of -d (default 16)
+ */
+int main(int argc, char **argv) {
+    //-2, -4 or -8 keep the tables in memory with that many bits per entry
+    int bits = 0;
+    int lookups = 2;
+    int threads = 1;
+    const char *batch = NULL;
+    const char *address = NULL;
+    const char *segment = NULL;
+    int capacity = 16;
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-2") == 0)
+            bits = 2;
+        else if (strcmp(argv[i], "-4") == 0)
+            bits = 4;
+        else if (strcmp(argv[i], "-8") == 0)
+            bits = 8;
+        else if ((strcmp(argv[i], "-m") == 0) && (i + 1 < argc))
+            segment = argv[++i];
+        else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+            lookups = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc))
+            threads = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc))
+            batch = argv[++i];
+        else if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc))
+            address = argv[++i];
+        else if ((strcmp(argv[i], "-q") == 0) && (i + 1 < argc))
+            capacity = atoi(argv[++i]);
+        else {
+            printf("Usage: %s [-8 | -4 | -2] [-m segment] [-s lookups] "
+                   "[-j threads] [-b file] [-d socket [-q requests]]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
 
-    Rubikpd rpd;
-    rpd.initializeAllWithFiles(); 
+    shared_ptr<Rubikpd> rpd = make_shared<Rubikpd>();
+    if ((segment == NULL) || !rpd->attach(segment)) {
+        if (!rpd->initializeAllWithFiles(bits)) {
+            printf("Run ./pdb to create the pattern databases\n");
+            return 1;
+        }
+
+        //Without the segment this process keeps its own tables
+        if (segment != NULL)
+            rpd->publish(segment);
+    }
+    rpd->setLookups(lookups);
+
+    if (address != NULL) {
+        Solver solver(rpd);
+        return serveSolver(solver, address, max(threads, 1), max(capacity, 0));
+    }
+
+    //Results are the only thing written to the standard output
+    if (batch != NULL) {
+        FILE *in = stdin;
+        if (strcmp(batch, "-") != 0)
+            in = fopen(batch, "r");
+        if (in == NULL) {
+            fprintf(stderr, "Can't open %s\n", batch);
+            return 1;
+        }
+
+        Solver solver(rpd);
+        solver.warmUp();
+        long solved = solveBatch(solver, in, stdout, max(threads, 1));
+        fprintf(stderr, "Cubes solved: %ld\n", solved);
+        if (in != stdin)
+            fclose(in);
+        return 0;
+    }
+
+    printf("Lookups per node: %d\n", rpd->getLookups());
     
     Rubik cube;
     cube.random();  //Random instance
@@ -24,7 +116,8 @@ int main() {
     cube.print();
     printf("-----------------------------------------------\n");
 
+    Solver solver(rpd, threads);
     Solution solution;
-    solution = IDAstar(cube, rpd);
+    solution = solver.solve(cube);
     print_solution(solution);
 }
@@ -0,0 +1,214 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Move pruning class
+  */
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include "movepruning.hh"
+#include "rubik.hh"
+
+using namespace std;
+
+
+/**
+  * Returns the move pruning automaton, building it the first time
+  * @return Automaton shared by every search
+  */
+
+const MovePruning &MovePruning::tables() {
+    static MovePruning tables;    //Built once, even with several threads
+    return tables;
+};
+
+
+/**
+  * Gets a key that tells cubes apart
+  * @param 'cube' : Rubik's cube
+  * @return The 20 cubies
+  */
+
+static string cubeKey(Rubik cube) {
+    string key(20, '\x00');
+    int i;
+    for (i = 0; i < 20; i++)
+        key[i] = cube.getCubie(i);
+    return key;
+};
+
+
+/**
+  * Finds the duplicates and builds the automaton
+  */
+
+MovePruning::MovePruning() {
+    //Sequences are numbered in base MOVES + 1, one digit per move (move m
+    //is digit m + 1), so the last moves of a sequence are its number
+    //modulo a power of MOVES + 1
+    long powers[PRUNING_DEPTH + 1];
+    int n, k, m, i;
+    powers[0] = 1;
+    for (n = 1; n <= PRUNING_DEPTH; n++)
+        powers[n] = powers[n - 1]*(MOVES + 1);
+
+    //Canonical sequences of the last length, in order, and their cubes
+    vector<long> level(1, 0);
+    vector<Rubik> cubes(1);
+    cubes[0].transformToGoal();
+
+    unordered_set<string> seen;
+    seen.reserve(SEQUENCES);
+    seen.insert(cubeKey(cubes[0]));
+
+    vector<long> duplicates;
+    unordered_set<long> found;
+    for (n = 1; n <= PRUNING_DEPTH; n++) {
+        vector<long> next;
+        vector<Rubik> nextCubes;
+        for (k = 0; k < (int) level.size(); k++) {
+            for (m = 0; m < MOVES; m++) {
+                long sequence = level[k]*(MOVES + 1) + m + 1;
+
+                //The prefix is canonical, but a suffix may not be
+                bool canonical = true;
+                for (i = 2; (i < n) && canonical; i++)
+                    canonical = found.count(sequence % powers[i]) == 0;
+                if (!canonical)
+                    continue;
+
+                Rubik cube = cubes[k].clone();
+                cube.turn(m / 3, (m % 3) + 1);
+                if (seen.insert(cubeKey(cube)).second) {
+                    next.push_back(sequence);
+                    nextCubes.push_back(cube);
+                }
+                else {
+                    duplicates.push_back(sequence);
+                    found.insert(sequence);
+                }
+            }
+        }
+        level.swap(next);
+        cubes.swap(nextCubes);
+    }
+
+    //Trie of the duplicates, with the longest proper suffix of every node
+    //that is also in the trie
+    vector<int> trie(MOVES, -1);
+    vector<bool> pruned(1, false);
+    for (k = 0; k < (int) duplicates.size(); k++) {
+        n = 0;
+        while (duplicates[k] >= powers[n])
+            n++;
+
+        int node = 0;
+        for (i = n - 1; i >= 0; i--) {
+            m = (duplicates[k] / powers[i]) % (MOVES + 1) - 1;
+            if (trie[node*MOVES + m] < 0) {
+                trie[node*MOVES + m] = pruned.size();
+                pruned.push_back(false);
+                trie.resize(trie.size() + MOVES, -1);
+            }
+            node = trie[node*MOVES + m];
+        }
+        pruned[node] = true;
+    }
+
+    int nodes = pruned.size();
+    vector<int> suffix(nodes, 0);
+    vector<int> order(1, 0);      //Nodes breadth first
+    for (k = 0; k < (int) order.size(); k++) {
+        int node = order[k];
+        pruned[node] = pruned[node] || pruned[suffix[node]];
+        for (m = 0; m < MOVES; m++) {
+            int child = trie[node*MOVES + m];
+            int fallback = 0;
+            if (node != 0)
+                fallback = trie[suffix[node]*MOVES + m];
+
+            if (child < 0)
+                trie[node*MOVES + m] = fallback;
+            else {
+                suffix[child] = fallback;
+                order.push_back(child);
+            }
+        }
+    }
+
+    //Nodes that end in a duplicate are never reached
+    vector<int> state(nodes, -1);
+    this->states = 0;
+    for (k = 0; k < nodes; k++) {
+        if (!pruned[order[k]])
+            state[order[k]] = this->states++;
+    }
+
+    this->nexts = new int[this->states*MOVES];
+    this->valid = new int[this->states*MOVES];
+    this->number = new int[this->states];
+    for (k = 0; k < nodes; k++) {
+        int s = state[order[k]];
+        if (s < 0)
+            continue;
+
+        this->number[s] = 0;
+        for (m = 0; m < MOVES; m++) {
+            int t = state[trie[order[k]*MOVES + m]];
+            this->nexts[s*MOVES + m] = t;
+            if (t >= 0)
+                this->valid[s*MOVES + this->number[s]++] = m;
+        }
+    }
+};
+
+
+/**
+  * Frees the automaton
+  */
+
+MovePruning::~MovePruning() {
+    delete[] this->nexts;
+    delete[] this->valid;
+    delete[] this->number;
+};
+
+
+/**
+  * Gets the moves that aren't pruned after a path
+  * @param 'state' : state of the automaton after the path
+  * @param 'moves' : where a pointer to the moves, in order, is stored
+  * @return The number of moves
+  */
+
+int MovePruning::moves(int state, const int **moves) const {
+    *moves = &this->valid[state*MOVES];
+    return this->number[state];
+};
+
+
+/**
+  * Gets the state of the automaton after a move
+  * @param 'state' : state of the automaton before the move
+  * @param 'm'     : move (between 0 and 17) that isn't pruned
+  * @return State after the move
+  */
+
+int MovePruning::next(int state, int m) const {
+    return this->nexts[state*MOVES + m];
+};
+
+
+/**
+  * Gets the number of states of the automaton
+  * @return The number of states
+  */
+
+int MovePruning::size() const {
+    return this->states;
+};
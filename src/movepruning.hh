@@ -0,0 +1,66 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Move pruning class header
+  */
+
+#ifndef MOVEPRUNING_HH
+#define MOVEPRUNING_HH
+
+#include "movetables.hh"
+
+/*
+ * Length of the longest sequences of moves compared to find duplicates,
+ * and the number of cubes that are at most that many moves away from the
+ * goal (1 + 18 + 243 + 3240 + 43239 + 574908)
+ */
+#define PRUNING_DEPTH 5
+#define SEQUENCES 621649
+
+/*
+ * Automaton that only lets canonical sequences of moves through. Sequences
+ * are ordered by length, and sequences of the same length by their moves;
+ * a sequence is a duplicate when an earlier sequence makes the same cube
+ * (F F is the same as F2, R L as L R). Replacing a duplicate inside a path
+ * by the earlier sequence gives an earlier path that is not longer, so the
+ * first of the optimal solutions never has a duplicate inside, and a
+ * search can skip every path that does.
+ *
+ * The duplicates are found by making every sequence of up to PRUNING_DEPTH
+ * moves that has no shorter duplicate inside, and the automaton keeps the
+ * part of the path that can still turn into one of them (Aho-Corasick).
+ * State 0 is the empty path. Sequences of two moves give the usual rule: a
+ * face is never turned twice in a row, and of two opposite faces the
+ * second one is never turned right after the first one. Longer
+ * sequences add a few more (half turns of the right, top, bottom and left
+ * faces make the same cube as half turns of the left, top, bottom and
+ * right faces), which takes the average number of children from 13.35 to
+ * 13.30.
+ *
+ * The automaton is built once, the first time it is needed, and shared by
+ * every thread
+ */
+class MovePruning {
+    private:
+        int states;              //Number of states
+        int *nexts;              //[states][MOVES] next state, or -1
+        int *valid;              //[states][MOVES] moves that aren't pruned
+        int *number;             //[states] number of moves not pruned
+
+    public:
+        static const MovePruning &tables();
+        int moves(int, const int **) const;
+        int next(int, int) const;
+        int size() const;
+    private:
+        MovePruning();
+        ~MovePruning();
+        MovePruning(const MovePruning &);           //Tables are never copied
+        MovePruning &operator=(const MovePruning &);
+};
+
+#endif
@@ -0,0 +1,368 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Move tables class
+  */
+
+#include "movetables.hh"
+#include "rubik.hh"
+#include "utils.hh"
+
+/*
+ * edges1 are the edges of the left face and then the middle face
+ */
+const int MoveTables::pattern[EDGES_MAX] = {1, 3, 5, 7, 16, 17, 18, 19};
+
+
+/**
+  * Returns the move tables, building them the first time
+  * @return Move tables shared by every pattern database
+  */
+
+const MoveTables &MoveTables::tables() {
+    static MoveTables tables;    //Built once, even with several threads
+    return tables;
+};
+
+
+/**
+  * Builds every table from the moves of the Rubik class
+  */
+
+MoveTables::MoveTables() {
+    //What every cubie becomes after every move
+    unsigned char cubies[MOVES][256];
+    int m, i;
+    for (m = 0; m < MOVES; m++) {
+        for (i = 0; i < 256; i++)
+            cubies[m][i] = Rubik::turnCubie(m / 3, (m % 3) + 1, i);
+    }
+
+    this->initializeCorners(cubies);
+    this->initializeEdges(cubies);
+};
+
+
+/**
+  * Frees the tables
+  */
+
+MoveTables::~MoveTables() {
+    delete[] this->cornersP;
+    delete[] this->cornersFace;
+    delete[] this->edgesP;
+};
+
+
+/**
+  * Gets the index in the corners table of a successor
+  * @param 'i' : index of a state in the corners table
+  * @param 'm' : move (between 0 and 17)
+  * @return Index of the successor
+  */
+
+long MoveTables::moveCorners(long i, int m) const {
+    int p = i / CORNERS_O;
+    int o = i % CORNERS_O;
+    int mask = this->cornersFace[p*6 + m/3];
+
+    //Cubies 0..3 are the four most significant orientations
+    int high = this->cornersO[m][mask >> 4][o / 81];
+    int low = this->cornersO[m][mask & 15][o % 81];
+
+    return (long) this->cornersP[p*MOVES + m]*CORNERS_O + high*81 + low;
+};
+
+
+/**
+  * Gets the index in an edges table of a successor
+  * @param 'k' : number of edges of the table
+  * @param 'i' : index of a state in edges1 or edges2
+  * @param 'm' : move (between 0 and 17)
+  * @return Index of the successor
+  */
+
+long MoveTables::moveEdges(int k, long i, int m) const {
+    if (k == 6) {
+        unsigned int move = this->edgesP[(i / EDGES_O)*MOVES + m];
+        int positions = move & 0xFFFFF;
+        int orientations = (i % EDGES_O) ^ (move >> 20);
+
+        return (long) positions*EDGES_O + orientations;
+    }
+
+    long orientations = 1L << k;
+    int positions[EDGES_MAX];
+    MoveTables::unrankEdgesP(k, i / orientations, positions);
+
+    int flip;
+    int moved = this->movePositions(k, positions, m, &flip);
+    return moved*orientations + ((i % orientations) ^ flip);
+};
+
+
+/**
+  * Gets the indexes of the 18 successors of a state in the corners table
+  * @param 'i'        : index of the state
+  * @param 'children' : array where the 18 indexes are stored
+  */
+
+void MoveTables::successorsCorners(long i, long *children) const {
+    int m;
+    for (m = 0; m < MOVES; m++)
+        children[m] = this->moveCorners(i, m);
+};
+
+
+/**
+  * Gets the indexes of the 18 successors of a state in an edges table
+  * @param 'k'        : number of edges of the table
+  * @param 'i'        : index of the state
+  * @param 'children' : array where the 18 indexes are stored
+  */
+
+void MoveTables::successorsEdges(int k, long i, long *children) const {
+    int m;
+    if (k == 6) {
+        for (m = 0; m < MOVES; m++)
+            children[m] = this->moveEdges(k, i, m);
+        return;
+    }
+
+    //Positions are unranked once for the 18 moves
+    long orientations = 1L << k;
+    int positions[EDGES_MAX];
+    MoveTables::unrankEdgesP(k, i / orientations, positions);
+
+    for (m = 0; m < MOVES; m++) {
+        int flip;
+        int moved = this->movePositions(k, positions, m, &flip);
+        children[m] = moved*orientations + ((i % orientations) ^ flip);
+    }
+};
+
+
+/**
+  * Ranks the positions of the corners the same way Rubikpd::rankCornersP
+  * does it
+  * @param 'positions' : position / 2 of the cubies 0, 2, ..., 14
+  * @return Permutation of positions (value between 0 and 40319)
+  */
+
+int MoveTables::rankCornersP(const int *positions) {
+    return rankPermutation(8, 8, positions);
+};
+
+
+/**
+  * Unranks the positions of the corners
+  * @param 'x'         : permutation of positions (between 0 and 40319)
+  * @param 'positions' : array where position / 2 of the cubies 0, 2, ...,
+  *                      14 are stored
+  */
+
+void MoveTables::unrankCornersP(int x, int *positions) {
+    unrankPermutation(8, 8, x, positions);
+};
+
+
+/**
+  * Ranks the positions of k edges the same way Rubikpd::rankEdgesP
+  * does it. Edge positions 1, 3, ..., 15 are numbered 0..7, and 16..19
+  * are numbered 8..11
+  * @param 'k'         : number of edges (6, 7 or 8)
+  * @param 'positions' : numbers of the positions of the k edges
+  * @return Permutation of positions (value between 0 and 12!/(12-k)! - 1)
+  */
+
+int MoveTables::rankEdgesP(int k, const int *positions) {
+    return rankPermutation(k, 12, positions);
+};
+
+
+/**
+  * Unranks the positions of k edges
+  * @param 'k'         : number of edges (6, 7 or 8)
+  * @param 'x'         : permutation of positions
+  * @param 'positions' : array where the numbers of the positions of the k
+  *                      edges are stored
+  */
+
+void MoveTables::unrankEdgesP(int k, int x, int *positions) {
+    unrankPermutation(k, 12, x, positions);
+};
+
+
+/**
+  * Gets the number of permutations of the positions of k edges
+  * @param 'k' : number of edges (6, 7 or 8)
+  * @return 12!/(12-k)!
+  */
+
+int MoveTables::edgesPositions(int k) {
+    int n = 1;
+    int i;
+    for (i = 12 - k + 1; i <= 12; i++)
+        n = n*i;
+    return n;
+};
+
+
+/**
+  * Builds the tables of corner positions and orientations
+  * @param 'cubies' : what every cubie becomes after every move
+  */
+
+void MoveTables::initializeCorners(unsigned char (*cubies)[256]) {
+    this->cornersP = new unsigned short[CORNERS_P*MOVES];
+    this->cornersFace = new unsigned char[CORNERS_P*6];
+
+    //Orientations X, Y, Z are 0, 2 and 1 in the corners table (% 4)
+    int axis[3] = {4, 1, 2};
+    int m, i, k;
+
+    //New position / 2 of the corner in every position / 2
+    int corners[MOVES][8];
+    bool face[6][8];
+    for (m = 0; m < MOVES; m++) {
+        for (i = 0; i < 8; i++)
+            corners[m][i] = (cubies[m][(i*2) << 3] >> 3) / 2;
+    }
+    for (i = 0; i < 6; i++) {
+        for (k = 0; k < 8; k++)
+            face[i][k] = corners[i*3][k] != k;
+    }
+
+    int x;
+    for (x = 0; x < CORNERS_P; x++) {
+        int positions[8];
+        MoveTables::unrankCornersP(x, positions);
+
+        for (i = 0; i < 6; i++) {
+            //Cubie 0 is the most significant bit
+            int mask = 0;
+            for (k = 0; k < 8; k++) {
+                if (face[i][positions[k]])
+                    mask = mask | (1 << (7 - k));
+            }
+            this->cornersFace[x*6 + i] = mask;
+        }
+
+        for (m = 0; m < MOVES; m++) {
+            int moved[8];
+            for (k = 0; k < 8; k++)
+                moved[k] = corners[m][positions[k]];
+            this->cornersP[x*MOVES + m] = MoveTables::rankCornersP(moved);
+        }
+    }
+
+    //Orientations of four cubies, turned when their bit in mask is set
+    for (m = 0; m < MOVES; m++) {
+        //Any corner of the face turns the same way
+        int position = 0;
+        while (!face[m / 3][position])
+            position++;
+
+        int turned[3];
+        for (i = 0; i < 3; i++) {
+            unsigned char cubie = ((position*2) << 3) | axis[i];
+            turned[i] = (cubies[m][cubie] & 7) % 4;
+        }
+
+        int mask;
+        for (mask = 0; mask < 16; mask++) {
+            for (x = 0; x < 81; x++) {
+                int y = x;
+                int rank = 0;
+                for (k = 3; k >= 0; k--) {
+                    int power = pow(3, k);
+                    int digit = y / power;
+                    y = y - (digit*power);
+                    if (mask & (1 << k))
+                        digit = turned[digit];
+                    rank = (rank*3) + digit;
+                }
+                this->cornersO[m][mask][x] = rank;
+            }
+        }
+    }
+};
+
+
+/**
+  * Builds the table of edge positions and flips
+  * @param 'cubies' : what every cubie becomes after every move
+  */
+
+void MoveTables::initializeEdges(unsigned char (*cubies)[256]) {
+    this->edgesP = new unsigned int[EDGES_P*MOVES];
+
+    //New number of the edge in every position, and whether it flips
+    int m, i;
+    for (m = 0; m < MOVES; m++) {
+        for (i = 0; i < 12; i++) {
+            int position = i*2 + 1;
+            if (i >= 8)
+                position = i + 8;
+
+            //Maximum orientation is X in the left and right faces, and Y
+            //in the middle face (see Rubik::isMaxOriented)
+            int orientation = 4;
+            if (position >= 16)
+                orientation = 2;
+
+            unsigned char cubie = cubies[m][(position << 3) | orientation];
+            int moved = cubie >> 3;
+            int max = 4;
+            if (moved >= 16)
+                max = 2;
+
+            this->edges[m][i] = moved / 2;
+            if (moved >= 16)
+                this->edges[m][i] = moved - 8;
+            this->flips[m][i] = (cubie & 7) != max;
+        }
+    }
+
+    int x;
+    for (x = 0; x < EDGES_P; x++) {
+        int positions[6];
+        MoveTables::unrankEdgesP(6, x, positions);
+
+        for (m = 0; m < MOVES; m++) {
+            int flip;
+            unsigned int rank = this->movePositions(6, positions, m, &flip);
+            this->edgesP[x*MOVES + m] = (flip << 20) | rank;
+        }
+    }
+};
+
+
+/**
+  * Moves the positions of k edges
+  * @param 'k'         : number of edges (6, 7 or 8)
+  * @param 'positions' : numbers of the positions of the k edges
+  * @param 'm'         : move (between 0 and 17)
+  * @param 'flip'      : where the mask of the edges that flip is stored
+  * @return Permutation of the new positions
+  */
+
+int MoveTables::movePositions(int k, const int *positions, int m,
+                              int *flip) const {
+    int moved[EDGES_MAX];
+    int mask = 0;
+    int j;
+    for (j = 0; j < k; j++) {
+        moved[j] = this->edges[m][positions[j]];
+        //First edge is the most significant bit
+        if (this->flips[m][positions[j]])
+            mask = mask | (1 << (k - 1 - j));
+    }
+
+    *flip = mask;
+    return MoveTables::rankEdgesP(k, moved);
+};
@@ -0,0 +1,90 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Move tables class header
+  */
+
+#ifndef MOVETABLES_HH
+#define MOVETABLES_HH
+
+/*
+ * Number of moves (6 faces turned 90, 180 and 270 degrees). Move m turns
+ * face m / 3, (m % 3) + 1 times, in the same order as Rubik::getSucc
+ */
+#define MOVES 18
+
+/*
+ * Sizes of the coordinates of the pattern databases
+ */
+#define CORNERS_P 40320      //8! corner positions
+#define CORNERS_O 6561       //3^8 corner orientations
+#define EDGES_P   665280     //12!/6! positions of six edges
+#define EDGES_O   64         //2^6 orientations of six edges
+
+/*
+ * Largest number of edges in an edge pattern database
+ */
+#define EDGES_MAX 8
+
+/*
+ * Transitions of the coordinates used by the pattern databases. Every
+ * index of a table is made of a position coordinate and an orientation
+ * coordinate (see Rubikpd), and these tables give the coordinates of the
+ * 18 successors of a state without building any Rubik's cube:
+ *
+ * - Corner positions go to new corner positions.
+ * - Corner orientations only change for the cubies on the turned face, so
+ *   the orientations are split in two halves of four cubies, and each half
+ *   is turned with the mask of its cubies that are on the face.
+ * - Edge positions go to new edge positions together with the mask of the
+ *   six edges whose orientation flips (edge orientations only depend on
+ *   the position they are in).
+ *
+ * The same edge tables serve edges1 and edges2, since both rank six edge
+ * positions the same way. Patterns of seven or eight edges (see pattern)
+ * have too many positions for a table, so their successors are ranked
+ * again from the new number and flip of the edge in every position. The
+ * tables are built once, the first time they are needed, and shared by
+ * every thread
+ */
+class MoveTables {
+    private:
+        unsigned short *cornersP;     //[CORNERS_P][MOVES] new positions
+        unsigned char *cornersFace;   //[CORNERS_P][6] cubies on each face
+        unsigned short cornersO[MOVES][16][81];  //Turned halves
+        unsigned int *edgesP;         //[EDGES_P][MOVES] flips << 20 | positions
+        int edges[MOVES][12];         //New number of the edge in a position
+        bool flips[MOVES][12];        //Whether it flips
+
+    public:
+        /*
+         * Cubies of edges1 in the order they are ranked. A pattern of k
+         * edges takes the first k cubies
+         */
+        static const int pattern[EDGES_MAX];
+
+        static const MoveTables &tables();
+        long moveCorners(long, int) const;
+        long moveEdges(int, long, int) const;
+        void successorsCorners(long, long *) const;
+        void successorsEdges(int, long, long *) const;
+        static int rankCornersP(const int *);
+        static void unrankCornersP(int, int *);
+        static int rankEdgesP(int, const int *);
+        static void unrankEdgesP(int, int, int *);
+        static int edgesPositions(int);
+    private:
+        MoveTables();
+        ~MoveTables();
+        MoveTables(const MoveTables &);             //Tables are never copied
+        MoveTables &operator=(const MoveTables &);
+        void initializeCorners(unsigned char (*)[256]);
+        void initializeEdges(unsigned char (*)[256]);
+        int movePositions(int, const int *, int, int *) const;
+};
+
+#endif
@@ -0,0 +1,730 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Pattern database table class definition
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "pdbtable.hh"
+
+using namespace std;
+
+
+/**
+  * Updates a checksum (FNV-1a over 64 bit words, bytes for the tail)
+  * @param 'h'   : checksum so far
+  * @param 'buf' : bytes to add
+  * @param 'n'   : number of bytes
+  * @return The new checksum
+  */
+
+static unsigned long long addChecksum(unsigned long long h,
+                                      const unsigned char *buf, size_t n) {
+    const unsigned long long prime = 1099511628211ULL;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        unsigned long long word;
+        memcpy(&word, buf + i, 8);
+        h = (h ^ word) * prime;
+    }
+
+    for (; i < n; i++)
+        h = (h ^ buf[i]) * prime;
+
+    return h;
+};
+
+
+/**
+  * Asks the kernel to back memory with transparent huge pages. It is only
+  * a hint: whether it is taken depends on
+  * /sys/kernel/mm/transparent_hugepage
+  * @param 'map'   : start of the memory, aligned to a page
+  * @param 'bytes' : length of the memory
+  */
+
+void adviseHugePages(void *map, size_t bytes) {
+    madvise(map, bytes, MADV_HUGEPAGE);
+};
+
+
+/**
+  * Allocates memory for a table on the largest pages it can get: 1 GB
+  * pages for tables of at least 1 GB, then 2 MB pages, both from the huge
+  * page pool (vm.nr_hugepages), and otherwise normal pages that the kernel
+  * is asked to back with transparent huge pages. Lookups are spread over
+  * the whole table, so with 4 KB pages almost every one misses the TLB
+  * @param 'bytes'  : size of the table
+  * @param 'length' : where the size of the allocation is stored
+  * @return The memory, or NULL if it couldn't be allocated
+  */
+
+static void *allocatePages(size_t bytes, size_t *length) {
+    size_t sizes[2] = {1UL << 30, 1UL << 21};
+    int flags[2] = {30 << MAP_HUGE_SHIFT, 21 << MAP_HUGE_SHIFT};
+    void *map;
+    int k;
+    for (k = 0; k < 2; k++) {
+        if (bytes < sizes[k])
+            continue;
+
+        *length = (bytes + sizes[k] - 1) / sizes[k] * sizes[k];
+        map = mmap(NULL, *length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | flags[k], -1, 0);
+        if (map != MAP_FAILED)
+            return map;
+    }
+
+    *length = bytes;
+    map = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    adviseHugePages(map, bytes);
+    return map;
+};
+
+
+/**
+  * Stores a value in the i-th entry of packed entries
+  * @param 'data'  : packed entries
+  * @param 'bits'  : bits per entry (8, 4 or 2)
+  * @param 'i'     : index of the entry
+  * @param 'value' : value to store
+  */
+
+static void store(unsigned char *data, int bits, long i, int value) {
+    if (bits == 8) {
+        data[i] = value;
+        return;
+    }
+
+    //Lower entries go in the lower bits of the byte
+    int perbyte = 8 / bits;
+    int shift = (i % perbyte) * bits;
+    int mask = (1 << bits) - 1;
+    unsigned char byte = data[i / perbyte] & ~(mask << shift);
+    data[i / perbyte] = byte | ((value & mask) << shift);
+};
+
+
+/**
+  * Makes an empty table
+  */
+
+PdbTable::PdbTable() {
+    this->data = NULL;
+    this->entries = 0;
+    this->bits = 8;
+    this->checksum = 0;
+    this->region = NULL;
+    this->length = 0;
+    this->mapped = false;
+};
+
+
+/**
+  * Frees the memory or unmaps the file that holds the entries
+  */
+
+PdbTable::~PdbTable() {
+    this->release();
+};
+
+
+/**
+  * Allocates memory for 'n' entries. Every entry starts unreached
+  * @param 'n'    : number of entries
+  * @param 'bits' : bits per entry (8, 4, or 2 to keep costs mod 3)
+  * @return True if the memory could be allocated. False in any other case
+  */
+
+bool PdbTable::allocate(long n, int bits) {
+    this->release();
+
+    size_t bytes = (n * bits + 7) / 8;
+    size_t length;
+    unsigned char *memory = (unsigned char *) allocatePages(bytes, &length);
+    if (memory == NULL) {
+        fprintf(stderr, "Can't allocate %ld entries\n", n);
+        return false;
+    }
+
+    memset(memory, 0xFF, bytes);    //Largest value in every entry
+
+    this->data = memory;
+    this->entries = n;
+    this->bits = bits;
+    this->region = memory;
+    this->length = length;
+    this->mapped = false;
+    return true;
+};
+
+
+/**
+  * Copies the entries into memory with 'bits' bits each, so they are on
+  * huge pages. Tables already in memory with that size are kept, and
+  * mapped files with that size are copied as they are. Costs that don't
+  * fit are stored as the largest value. Tables that keep costs mod 3 can't
+  * be unpacked
+  * @param 'bits' : bits per entry (8, 4 or 2)
+  * @return True if the table could be packed. False in any other case
+  */
+
+bool PdbTable::pack(int bits) {
+    if ((this->bits == bits) && !this->mapped)
+        return true;
+
+    if ((this->bits == 2) && (bits != 2)) {
+        fprintf(stderr, "Costs kept mod 3 can't be unpacked\n");
+        return false;
+    }
+
+    size_t bytes = (this->entries * bits + 7) / 8;
+    size_t length;
+    unsigned char *memory = (unsigned char *) allocatePages(bytes, &length);
+    if (memory == NULL) {
+        fprintf(stderr, "Can't allocate %ld entries\n", this->entries);
+        return false;
+    }
+
+    if (this->mapped)
+        madvise(this->region, this->length, MADV_SEQUENTIAL);
+
+    long i;
+    if (this->bits == bits)
+        memcpy(memory, this->data, bytes);
+    else
+        for (i = 0; i < this->entries; i++)
+            store(memory, bits, i, this->packed(this->get(i), bits));
+
+    long n = this->entries;
+    this->release();
+    this->data = memory;
+    this->entries = n;
+    this->bits = bits;
+    this->region = memory;
+    this->length = length;
+    this->mapped = false;
+    return true;
+};
+
+
+/**
+  * Maps a pattern database file read-only into memory. Pages are read
+  * from disk when first touched. The file is either a .pdb file, whose
+  * header must match 'kind' and 'n', or a .bin file written as one int
+  * per entry
+  * @param 'name' : name of the file
+  * @param 'kind' : PDB_CORNERS, PDB_EDGES1 or PDB_EDGES2
+  * @param 'n'    : number of entries the file must have
+  * @return True if the file could be mapped. False in any other case
+  */
+
+bool PdbTable::mapFile(const char *name, int kind, long n) {
+    this->release();
+
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Can't open %s\n", name);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "Can't read %s\n", name);
+        close(fd);
+        return false;
+    }
+
+    bool ok = this->mapRange(fd, name, 0, st.st_size, kind, n);
+    close(fd);    //The mapping keeps its own reference to the file
+    return ok;
+};
+
+
+/**
+  * Maps read-only the part of an open file (or shared memory segment)
+  * that holds a .pdb image or the ints of a .bin file
+  * @param 'fd'     : descriptor of the file
+  * @param 'name'   : name of the file, for messages
+  * @param 'offset' : start of the table in the file (a multiple of the
+  *                   page size)
+  * @param 'size'   : length of the table in bytes
+  * @param 'kind'   : PDB_CORNERS, PDB_EDGES1 or PDB_EDGES2
+  * @param 'n'      : number of entries the table must have
+  * @return True if the table could be mapped. False in any other case
+  */
+
+bool PdbTable::mapRange(int fd, const char *name, size_t offset, size_t size,
+                        int kind, long n) {
+    this->release();
+
+    void *map = MAP_FAILED;
+    if (size > 0)
+        map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, offset);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Can't map %s\n", name);
+        return false;
+    }
+
+    this->region = map;
+    this->length = size;
+    this->mapped = true;
+    this->entries = n;
+
+    bool ok;
+    if ((size >= sizeof(PdbHeader)) && (memcmp(map, "RUBIKPDB", 8) == 0)) {
+        ok = this->mapHeader(name, kind, n, size);
+    }
+    else {
+        //Old .bin file: one int per entry and no header
+        this->data = (unsigned char *) map;
+        this->bits = 32;
+        ok = (size == n * sizeof(int));
+        if (!ok)
+            fprintf(stderr, "%s should have %ld entries\n", name, n);
+    }
+
+    if (!ok) {
+        this->release();
+        return false;
+    }
+
+    //Lookups are random, so reading ahead around them only wastes memory
+    madvise(map, size, MADV_RANDOM);
+    return true;
+};
+
+
+/**
+  * Checks the header of a mapped .pdb file and points data to its entries
+  * @param 'name' : name of the file
+  * @param 'kind' : kind of pattern database expected
+  * @param 'n'    : number of entries expected
+  * @param 'size' : size of the file
+  * @return True if the header is valid. False in any other case
+  */
+
+bool PdbTable::mapHeader(const char *name, int kind, long n, size_t size) {
+    PdbHeader header;
+    memcpy(&header, this->region, sizeof(PdbHeader));
+
+    if (header.version != PDB_VERSION) {
+        fprintf(stderr, "%s has version %u, expected %d\n", name,
+                header.version, PDB_VERSION);
+        return false;
+    }
+
+    if ((int) header.kind != kind) {
+        fprintf(stderr, "%s holds the wrong kind of table\n", name);
+        return false;
+    }
+
+    if (((long) header.entries != n) ||
+        ((header.bits != 8) && (header.bits != 4) && (header.bits != 2))) {
+        fprintf(stderr, "%s should have %ld entries\n", name, n);
+        return false;
+    }
+
+    this->bits = header.bits;
+    this->checksum = header.checksum;
+    if (size != sizeof(PdbHeader) + this->payload()) {
+        fprintf(stderr, "%s is truncated\n", name);
+        return false;
+    }
+
+    this->data = (unsigned char *) this->region + sizeof(PdbHeader);
+    return true;
+};
+
+
+/**
+  * Writes the table to a .pdb file
+  * @param 'name' : name of the file
+  * @param 'kind' : PDB_CORNERS, PDB_EDGES1 or PDB_EDGES2
+  * @param 'bits' : bits per entry in the file (8, 4 or 2). Costs that
+  *                 don't fit (unreached entries) are stored as the largest
+  *                 value, and with 2 bits every cost is stored mod 3
+  * @return True if the file could be written. False in any other case
+  */
+
+bool PdbTable::writeFile(const char *name, int kind, int bits) {
+    if ((this->bits == 2) && (bits != 2)) {
+        fprintf(stderr, "Costs kept mod 3 can't be unpacked\n");
+        return false;
+    }
+
+    FILE *fp;
+    fp = fopen(name, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Can't create %s\n", name);
+        return false;
+    }
+
+    PdbHeader header;
+    memset(&header, 0, sizeof(PdbHeader));
+    memcpy(header.magic, "RUBIKPDB", 8);
+    header.version = PDB_VERSION;
+    header.kind = kind;
+    header.entries = this->entries;
+    header.bits = bits;
+    //Checksum is written later
+    bool ok = (fwrite(&header, sizeof(PdbHeader), 1, fp) == 1);
+
+    if (this->mapped)
+        madvise(this->region, this->length, MADV_SEQUENTIAL);
+
+    //Entries are packed in chunks, not one fwrite per entry
+    int perbyte = 8 / bits;
+    unsigned long long sum = 14695981039346656037ULL;
+    unsigned char chunk[65536];
+    long i = 0;
+    while (ok && (i < this->entries)) {
+        size_t k = 0;
+        for (; (k < sizeof(chunk)) && (i < this->entries); k++) {
+            chunk[k] = 0;
+            int j;
+            for (j = 0; (j < perbyte) && (i < this->entries); j++) {
+                int value = this->packed(this->get(i++), bits);
+                chunk[k] = chunk[k] | (value << (j * bits));
+            }
+        }
+        sum = addChecksum(sum, chunk, k);
+        ok = (fwrite(chunk, 1, k, fp) == k);
+    }
+
+    if (this->mapped)
+        madvise(this->region, this->length, MADV_RANDOM);
+
+    header.checksum = sum;
+    ok = ok && (fseek(fp, 0, SEEK_SET) == 0) &&
+         (fwrite(&header, sizeof(PdbHeader), 1, fp) == 1);
+
+    //A short write (full disk) must not leave a truncated table behind
+    if ((fclose(fp) != 0) || !ok) {
+        fprintf(stderr, "Can't write %s\n", name);
+        remove(name);
+        return false;
+    }
+
+    return true;
+};
+
+
+/**
+  * Returns the size of the .pdb image of the table
+  * @param 'bits' : bits per entry of the image (8, 4 or 2)
+  * @return The size of the header and the packed entries in bytes
+  */
+
+size_t PdbTable::imageSize(int bits) const {
+    return sizeof(PdbHeader) + (this->entries * bits + 7) / 8;
+};
+
+
+/**
+  * Writes the table in memory as a .pdb file would hold it, such as into
+  * a shared memory segment
+  * @param 'image' : where the header and the entries are written
+  *                  (imageSize bytes, all zero)
+  * @param 'kind'  : PDB_CORNERS, PDB_EDGES1 or PDB_EDGES2
+  * @param 'bits'  : bits per entry of the image (8, 4 or 2)
+  * @return True if the table could be written. False in any other case
+  */
+
+bool PdbTable::writeImage(unsigned char *image, int kind, int bits) const {
+    if ((this->bits == 2) && (bits != 2)) {
+        fprintf(stderr, "Costs kept mod 3 can't be unpacked\n");
+        return false;
+    }
+
+    unsigned char *entries = image + sizeof(PdbHeader);
+    size_t bytes = this->imageSize(bits) - sizeof(PdbHeader);
+    if (this->bits == bits) {
+        memcpy(entries, this->data, bytes);
+    }
+    else {
+        long i;
+        for (i = 0; i < this->entries; i++)
+            store(entries, bits, i, this->packed(this->get(i), bits));
+    }
+
+    PdbHeader header;
+    memset(&header, 0, sizeof(PdbHeader));
+    memcpy(header.magic, "RUBIKPDB", 8);
+    header.version = PDB_VERSION;
+    header.kind = kind;
+    header.entries = this->entries;
+    header.bits = bits;
+    header.checksum = addChecksum(14695981039346656037ULL, entries, bytes);
+    memcpy(image, &header, sizeof(PdbHeader));
+    return true;
+};
+
+
+/**
+  * Checks the entries of a mapped .pdb file against its header checksum.
+  * This reads the whole file, so it is not done when a table is mapped
+  * @return True if the checksum matches. False in any other case
+  */
+
+bool PdbTable::verify() {
+    if ((!this->mapped) || (this->bits == 32))
+        return false;
+
+    madvise(this->region, this->length, MADV_SEQUENTIAL);
+    unsigned long long sum = 14695981039346656037ULL;
+    sum = addChecksum(sum, this->data, this->payload());
+    madvise(this->region, this->length, MADV_RANDOM);
+
+    return (sum == this->checksum);
+};
+
+
+/**
+  * Reads every page of a mapped file now, so the first lookups don't wait
+  * for the disk
+  */
+
+void PdbTable::prefetch() const {
+    if (!this->mapped)
+        return;
+
+    madvise(this->region, this->length, MADV_WILLNEED);
+    const volatile unsigned char *bytes =
+        (const volatile unsigned char *) this->region;
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t i;
+    for (i = 0; i < this->length; i += page)
+        bytes[i];
+};
+
+
+/**
+  * Asks the cache for the byte that holds the i-th entry, without waiting
+  * for it
+  * @param 'i' : index of the entry
+  */
+
+void PdbTable::prefetch(long i) const {
+    if (this->bits == 32)
+        __builtin_prefetch(this->data + i * sizeof(int));
+    else
+        __builtin_prefetch(this->data + ((i * this->bits) >> 3));
+};
+
+
+/**
+  * Describes the pages that back the table, as /proc/self/smaps reports
+  * them. Pages of a mapped file that weren't read yet count as small pages
+  * @param 'text' : where the description is stored (at least 64 chars)
+  */
+
+void PdbTable::describePages(char *text) const {
+    long megabytes = (long) (this->length >> 20);
+    long page = 4;       //KB
+    long huge = 0;       //KB on transparent huge pages
+
+    FILE *fp = fopen("/proc/self/smaps", "r");
+    if (fp != NULL) {
+        unsigned long start = (unsigned long) this->region;
+        bool inside = false;
+        char line[256];
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            unsigned long from, to;
+            long kb;
+            if (sscanf(line, "%lx-%lx ", &from, &to) == 2) {
+                if (inside)
+                    break;
+                inside = (from <= start) && (start < to);
+            }
+            else if (!inside)
+                continue;
+            else if (sscanf(line, "KernelPageSize: %ld kB", &kb) == 1)
+                page = kb;
+            else if ((sscanf(line, "AnonHugePages: %ld kB", &kb) == 1) ||
+                     (sscanf(line, "ShmemPmdMapped: %ld kB", &kb) == 1) ||
+                     (sscanf(line, "FilePmdMapped: %ld kB", &kb) == 1))
+                huge += kb;
+        }
+        fclose(fp);
+    }
+
+    if (page >= (1L << 20))
+        sprintf(text, "%ld MB on %ld GB pages", megabytes, page >> 20);
+    else if (page >= 1024)
+        sprintf(text, "%ld MB on %ld MB pages", megabytes, page >> 10);
+    else if (huge == 0)
+        sprintf(text, "%ld MB on %ld KB pages", megabytes, page);
+    else if ((huge >> 10) >= megabytes)
+        sprintf(text, "%ld MB on transparent huge pages", megabytes);
+    else
+        sprintf(text, "%ld MB, %ld MB of them on transparent huge pages",
+                megabytes, huge >> 10);
+};
+
+
+/**
+  * Frees the memory or unmaps the file that holds the entries
+  */
+
+void PdbTable::release() {
+    if (this->region != NULL)
+        munmap(this->region, this->length);
+
+    this->data = NULL;
+    this->entries = 0;
+    this->bits = 8;
+    this->checksum = 0;
+    this->region = NULL;
+    this->length = 0;
+    this->mapped = false;
+};
+
+
+/**
+  * Gets the cost of the i-th entry
+  * @param 'i' : index of the entry
+  * @return The cost stored in the i-th entry
+  */
+
+int PdbTable::get(long i) const {
+    switch (this->bits) {
+        case 8 : return this->data[i];
+        case 4 : return (this->data[i >> 1] >> ((i & 1) << 2)) & 15;
+        case 2 : return (this->data[i >> 2] >> ((i & 3) << 1)) & 3;
+    }
+    return ((const int *) this->data)[i];
+};
+
+
+/**
+  * Sets the cost of the i-th entry. Only tables in memory can be modified.
+  * Tables with 2 bits per entry keep the cost mod 3
+  * @param 'i'    : index of the entry
+  * @param 'cost' : cost to store
+  */
+
+void PdbTable::set(long i, int cost) {
+    if (this->bits == 2)
+        cost = cost % 3;
+    store(this->data, this->bits, i, cost);
+};
+
+
+/**
+  * Sets the cost of the i-th entry only if it hasn't been reached yet.
+  * The entry is updated with a compare-and-swap on the byte that holds
+  * it, so several threads can claim entries of the same table at once
+  * @param 'i'    : index of the entry
+  * @param 'cost' : cost to store
+  * @return True if this call set the entry. False if it was reached
+  */
+
+bool PdbTable::claim(long i, int cost) {
+    if (this->bits == 2)
+        cost = cost % 3;
+
+    int perbyte = 8 / this->bits;
+    int shift = (i % perbyte) * this->bits;
+    int mask = (1 << this->bits) - 1;
+    unsigned char *byte = &this->data[i / perbyte];
+
+    unsigned char old = __atomic_load_n(byte, __ATOMIC_RELAXED);
+    while (true) {
+        if (((old >> shift) & mask) != mask)
+            return false;    //Somebody else reached it first
+
+        unsigned char value = (old & ~(mask << shift)) | (cost << shift);
+        if (__atomic_compare_exchange_n(byte, &old, value, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return true;
+    }
+};
+
+
+/**
+  * Returns the value stored in entries that haven't been reached
+  * @return The largest value an entry can hold (255 in .bin files)
+  */
+
+int PdbTable::unreached() const {
+    if (this->bits == 32)
+        return 255;
+    return (1 << this->bits) - 1;
+};
+
+
+/**
+  * Says if the table keeps its costs mod 3 (2 bits per entry)
+  * @return True if the costs are kept mod 3. False in any other case
+  */
+
+bool PdbTable::isMod3() const {
+    return (this->bits == 2);
+};
+
+
+/**
+  * Returns the number of entries of the table
+  * @return The number of entries
+  */
+
+long PdbTable::size() const {
+    return this->entries;
+};
+
+
+/**
+  * Returns the number of bits used by each entry
+  * @return 8 or 4 for tables in memory and .pdb files, 32 for .bin files
+  */
+
+int PdbTable::bitsPerEntry() const {
+    return this->bits;
+};
+
+
+/**
+  * Converts a value of this table into a value of a table with 'bits'
+  * bits per entry
+  * @param 'value' : value read from this table
+  * @param 'bits'  : bits per entry of the other table (8, 4 or 2)
+  * @return The value to store in the other table
+  */
+
+int PdbTable::packed(int value, int bits) const {
+    int top = (1 << bits) - 1;
+
+    if (value >= this->unreached())
+        return top;
+    if (bits == 2)
+        return value % 3;
+    if (value > top)
+        return top;
+    return value;
+};
+
+
+/**
+  * Returns the number of bytes used by the entries
+  * @return Size of the packed entries
+  */
+
+size_t PdbTable::payload() const {
+    return (this->entries * this->bits + 7) / 8;
+};
@@ -0,0 +1,100 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Pattern database table class header
+  */
+
+#ifndef PDBTABLE_HH
+#define PDBTABLE_HH
+
+#include <stddef.h>
+
+/*
+ * Kinds of pattern databases stored in .pdb files
+ */
+#define PDB_CORNERS 1
+#define PDB_EDGES1  2
+#define PDB_EDGES2  3
+#define PDB_CORNERS_SYM 4    //Corners reduced by symmetry
+
+/*
+ * Version of the .pdb file format
+ */
+#define PDB_VERSION 1
+
+/*
+ * Header of a .pdb file (64 bytes). The entries follow the header
+ * packed with 'bits' bits each: 8 bits (one byte per entry), 4 bits
+ * (two entries per byte) or 2 bits (four entries per byte, costs mod 3).
+ * Lower entries go in the lower bits of each byte
+ */
+typedef struct PdbHeader PdbHeader;
+
+struct PdbHeader {
+    char magic[8];                 //"RUBIKPDB"
+    unsigned int version;          //PDB_VERSION
+    unsigned int kind;             //PDB_CORNERS, PDB_EDGES1 or PDB_EDGES2
+    unsigned long long entries;    //Number of entries
+    unsigned int bits;             //Bits per entry (8, 4 or 2)
+    unsigned int reserved;
+    unsigned long long checksum;   //Checksum of the packed entries
+    char padding[24];
+};
+
+/*
+ * Costs of one pattern database. They either live in memory allocated
+ * by the table itself or in a read-only mapping of a file (or of a shared
+ * memory segment, see Rubikpd::publish), so every process that maps the
+ * same file shares its pages through the page cache.
+ * Tables in memory keep one, two or four entries per byte. With four
+ * entries per byte only the cost mod 3 is kept, which is enough to recover
+ * the exact cost of a state from the exact cost of one of its neighbors,
+ * since the costs of neighbors differ by at most one
+ */
+class PdbTable {
+    private:
+        unsigned char *data;   //First entry
+        long entries;          //Number of entries
+        int bits;              //Bits per entry: 8, 4, 2 or 32 in .bin files
+        unsigned long long checksum;  //Checksum read from a .pdb header
+        void *region;          //Allocation or mapping that holds the entries
+        size_t length;         //Length of region in bytes
+        bool mapped;           //True if region is a mapping
+
+    public:
+        PdbTable();
+        ~PdbTable();
+        bool allocate(long,int);
+        bool pack(int);
+        bool mapFile(const char *, int, long);
+        bool mapRange(int, const char *, size_t, size_t, int, long);
+        bool writeFile(const char *, int, int);
+        size_t imageSize(int) const;
+        bool writeImage(unsigned char *, int, int) const;
+        bool verify();
+        void prefetch() const;
+        void prefetch(long) const;
+        void describePages(char *) const;
+        void release();
+        int get(long) const;
+        void set(long, int);
+        bool claim(long, int);
+        int unreached() const;
+        bool isMod3() const;
+        long size() const;
+        int bitsPerEntry() const;
+    private:
+        PdbTable(const PdbTable &);              //Tables are never copied
+        PdbTable &operator=(const PdbTable &);
+        bool mapHeader(const char *, int, long, size_t);
+        size_t payload() const;
+        int packed(int,int) const;
+};
+
+extern void adviseHugePages(void *,size_t);
+
+#endif
@@ -16,17 +16,150 @@
 #include <list>
 #include "rubik.hh"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RUBIK_X86
+#endif
+
 using namespace std;
 
 
+/*
+ * What every cubie becomes after each of the 18 moves (face*3 + times - 1)
+ */
+unsigned char Rubik::turns[18][256];
+
+/*
+ * The same moves for the vector kernels. For every move, the first 32
+ * bytes give the new position << 3 of every position, with the lowest bit
+ * set when the position is on the turned face. The last 16 bytes give the
+ * new orientation of every orientation: the first 8 off the face, the
+ * last 8 on the face
+ */
+unsigned char Rubik::vectorTurns[18][48];
+
+/*
+ * Kernels that apply a move to many cubes and get the 18 successors of a
+ * cube, chosen when the program starts by the features of the CPU, and
+ * their name
+ */
+void (*Rubik::kernel)(const Rubik *, Rubik *, int, int) = &Rubik::turnScalar;
+void (*Rubik::expander)(const Rubik *, Rubik *) = &Rubik::expandScalar;
+const char *Rubik::kernelname = "scalar";
+
+/*
+ * Words of the goal configuration
+ */
+unsigned long long Rubik::goal[RUBIK_WORDS];
+
+const bool Rubik::initialized = Rubik::initializeTables();
+
+
+/**
+  * Builds the table of moves from the turns of every face, and the goal
+  * @return True
+  */
+
+bool Rubik::initializeTables() {
+    //Faces you can move
+    unsigned char (*faces[6]) (unsigned char) = {
+        &Rubik::turnLeft,
+        &Rubik::turnRight,
+        &Rubik::turnTop,
+        &Rubik::turnBottom,
+        &Rubik::turnFront,
+        &Rubik::turnBack,
+    };
+
+    int face, times, i;
+    for (face = 0; face < 6; face++) {
+        for (i = 0; i < 256; i++) {
+            unsigned char cubie = i;
+            for (times = 1; times <= 3; times++) {
+                cubie = (*faces[face])(cubie);     //turn 90 degrees more
+                Rubik::turns[face*3 + times - 1][i] = cubie;
+            }
+        }
+    }
+
+    int m;
+    for (m = 0; m < 18; m++) {
+        unsigned char *vector = Rubik::vectorTurns[m];
+        int face = -1;
+        for (i = 0; i < 32; i++) {
+            int position = Rubik::turns[m][i << 3] >> 3;
+            vector[i] = position << 3;
+            if (position != i) {
+                vector[i] = vector[i] | 1;   //On the face
+                face = i;
+            }
+        }
+
+        for (i = 0; i < 8; i++) {
+            vector[32 + i] = i;
+            vector[40 + i] = Rubik::turns[m][(face << 3) | i] & '\x07';
+        }
+    }
+
+    Rubik cube;
+    cube.transformToGoal();
+    for (i = 0; i < RUBIK_WORDS; i++)
+        Rubik::goal[i] = cube.words[i];
+
+    Rubik::chooseKernel();
+
+    return true;
+};
+
+
+/**
+  * Chooses the fastest kernel the CPU can run
+  */
+
+void Rubik::chooseKernel() {
+#ifdef RUBIK_X86
+    __builtin_cpu_init();    //It may run before other constructors
+    if (__builtin_cpu_supports("avx2")) {
+        Rubik::kernel = &Rubik::turnAVX2;
+        Rubik::expander = &Rubik::expandAVX2;
+        Rubik::kernelname = "avx2";
+    }
+    else if (__builtin_cpu_supports("ssse3")) {
+        Rubik::kernel = &Rubik::turnSSSE3;
+        Rubik::expander = &Rubik::expandSSSE3;
+        Rubik::kernelname = "ssse3";
+    }
+#endif
+};
+
+
+/**
+  * Gets the name of the kernel used to turn cubes
+  * @return "avx2", "ssse3" or "scalar"
+  */
+
+const char *Rubik::kernelName() {
+    return Rubik::kernelname;
+};
+
+
+/**
+  * Makes a Rubik's cube with all cubies set to '\x00'
+  */
+
+Rubik::Rubik() {
+    this->clean();
+};
+
+
 /**
   * Sets all cubies to '\x00'
   */
 
 void Rubik::clean() {
     int i;
-    for (i = 0; i < 20; i++)
-        this->setCubie(i,'\x00');
+    for (i = 0; i < RUBIK_WORDS; i++)
+        this->words[i] = 0;
 };
 
 
@@ -102,29 +235,13 @@ void Rubik::random() {
 
     int i;
     srand(time(NULL));
-    int face = (rand() % 6) + 1;
+    int face = rand() % 6;
     for (i = 0; i < moves; i++) {
         int random = rand();
         srand(random);
-        face = (rand() % 6) + 1;
+        face = rand() % 6;
         int degrees = (rand() % 3) + 1;
-        int j;
-        for (j = 0; j < degrees; j++) {
-            switch (face) {
-                case 1 : this->turnLeft();
-                         break;
-                case 2 : this->turnRight();
-                         break;
-                case 3 : this->turnTop();
-                         break;
-                case 4 : this->turnBottom();
-                         break;
-                case 5 : this->turnFront();
-                         break;
-                case 6 : this->turnBack();
-                         break;
-            }
-        }
+        this->turn(face, degrees);
     }
 };
 
@@ -135,67 +252,43 @@ void Rubik::random() {
   */
 
 Rubik Rubik::clone() {
-    Rubik clone;
-    int i;
-
-    for (i = 0; i < 20; i++) {
-        clone.setCubie(i, this->getCubie(i));
-    }
-
-    return clone;
+    return *this;       //Copies the words
 };
 
 
 /**
-  * Sets the i-th cubie (or i % mod 20, if i >= 20)
-  * @param 'i' : number of i-th cubie
+  * Sets the i-th cubie
+  * @param 'i' : number of i-th cubie (between 0 and 19)
   */
 
 void Rubik::setCubie(int i, unsigned char cubie) {
-    int j = i % 20;
-
-    if ((j >= 0) && (j < 8)) 
-        this->left[j]  = cubie;
-    else if ((j >= 0) && (j < 16))
-        this->right[j % 8] = cubie;
-    else if ((j >= 0) && (j < 20))
-        this->middle[j % 8] = cubie;
+    this->cubies[i] = cubie;
 };
 
 
 /**
-  * Gets i-th cubie (or i % mod 20, if i >= 20)
-  * @param 'i' : number of i-th cubie
-  * @return The i-th Cubie, if i < 20. \xFF, in any other case
+  * Gets i-th cubie
+  * @param 'i' : number of i-th cubie (between 0 and 19)
+  * @return The i-th Cubie
   */
 
 unsigned char Rubik::getCubie(int i) {
-    int j = i % 20;
-    unsigned char cubie = '\xFF';
-
-    if ((j >= 0) && (j < 8)) 
-        cubie = this->left[j];
-    else if ((j >= 0) && (j < 16))
-        cubie = this->right[j % 8];
-    else if ((j >= 0) && (j < 20))
-        cubie = this->middle[j % 8];
-
-    return cubie;
-    
+    return this->cubies[i];
 };
 
 
 /**
-  * Change position i i-th cubie to 'position'
+  * Changes the position of a cubie to 'position'
+  * @param 'cubie'    : cubie
+  * @param 'position' : new position
+  * @return The cubie in its new position, with the same orientation
   */
 
-void Rubik::changePositionTo(int i, int position) {
-    unsigned char orientation;
-    orientation = this->getOrientation(i); 
-    unsigned char cubie = position;
+unsigned char Rubik::changePositionTo(unsigned char cubie, int position) {
+    unsigned char orientation = cubie & '\x07';
+    cubie = position;
     cubie = cubie << 3;  //Making place for orientation
-    cubie = cubie | orientation;
-    this->setCubie(i, cubie);
+    return cubie | orientation;
 };
 
 
@@ -206,206 +299,448 @@ void Rubik::changePositionTo(int i, int position) {
   */
 
 void Rubik::turn(int face, int times) {
-    //Moves that can be maded
-    void (Rubik::*moves[6]) () = {
-      &Rubik::turnLeft,     
-      &Rubik::turnRight, 
-      &Rubik::turnTop,  
-      &Rubik::turnBottom,
-      &Rubik::turnFront,
-      &Rubik::turnBack,
-    };
+    (*Rubik::kernel)(this, this, 1, face*3 + times - 1);
+};
 
-    int i;
-    for (i = 0; i < times; i++)
-        (this->*moves[face])();
 
-}
+/**
+  * Gets the 18 successors of this Rubik's cube, in the same order as
+  * getSucc
+  * @param 'children' : array where the 18 successors are stored
+  */
+
+void Rubik::expand(Rubik *children) {
+    (*Rubik::expander)(this, children);
+};
+
+
+/**
+  * Applies a move to many cubes, looking up every cubie in the table of
+  * moves, so no turn branches on the cubies
+  * @param 'in'   : cubes to be turned
+  * @param 'out'  : array where the turned cubes are stored (may be 'in')
+  * @param 'n'    : number of cubes
+  * @param 'm'    : move (face*3 + times - 1)
+  */
+
+void Rubik::turnScalar(const Rubik *in, Rubik *out, int n, int m) {
+    const unsigned char *move = Rubik::turns[m];
+
+    int k, i;
+    for (k = 0; k < n; k++) {
+        for (i = 0; i < 20; i++)
+            out[k].cubies[i] = move[in[k].cubies[i]];
+    }
+};
+
+
+/**
+  * Gets the 18 successors of a cube looking up every cubie in the table
+  * of moves
+  * @param 'in'       : cube
+  * @param 'children' : array where the 18 successors are stored
+  */
+
+void Rubik::expandScalar(const Rubik *in, Rubik *children) {
+    int m;
+    for (m = 0; m < 18; m++)
+        Rubik::turnScalar(in, &children[m], 1, m);
+};
+
+
+#ifdef RUBIK_X86
+
+/**
+  * Applies a move to 16 bytes of a cube with SSSE3. Every position is
+  * shuffled into its new position, and every orientation on the face into
+  * its new orientation
+  * @param 'cube'   : 16 bytes of a cube
+  * @param 'vector' : move in vectorTurns
+  * @return The 16 bytes after the move
+  */
+
+__attribute__((target("ssse3")))
+static inline __m128i vectorTurnSSSE3(__m128i cube,
+                                      const unsigned char *vector) {
+    const __m128i low = _mm_loadu_si128((const __m128i *) vector);
+    const __m128i high = _mm_loadu_si128((const __m128i *) (vector + 16));
+    const __m128i orientations = _mm_loadu_si128((const __m128i *)
+                                                 (vector + 32));
+    const __m128i sixteen = _mm_set1_epi8(16);
+    const __m128i seven = _mm_set1_epi8(7);
+    const __m128i one = _mm_set1_epi8(1);
+
+    __m128i position = _mm_and_si128(_mm_srli_epi16(cube, 3),
+                                     _mm_set1_epi8(0x1F));
+
+    //Positions 0..15 and 16..31 are looked up in different tables
+    __m128i ishigh = _mm_cmpeq_epi8(_mm_and_si128(position, sixteen), sixteen);
+    __m128i moved = _mm_or_si128(
+        _mm_andnot_si128(ishigh, _mm_shuffle_epi8(low, position)),
+        _mm_and_si128(ishigh, _mm_shuffle_epi8(high, position)));
+
+    __m128i onface = _mm_slli_epi16(_mm_and_si128(moved, one), 3);
+    __m128i orientation = _mm_or_si128(_mm_and_si128(cube, seven), onface);
+    orientation = _mm_shuffle_epi8(orientations, orientation);
+
+    return _mm_or_si128(_mm_andnot_si128(seven, moved), orientation);
+};
+
+
+/**
+  * Applies a move to a whole cube with AVX2. It does the same as
+  * vectorTurnSSSE3 on both halves at once
+  * @param 'cube'   : cube
+  * @param 'vector' : move in vectorTurns
+  * @return The cube after the move, with zeros after the 20 cubies
+  */
+
+__attribute__((target("avx2")))
+static inline __m256i vectorTurnAVX2(__m256i cube,
+                                     const unsigned char *vector) {
+    //Shuffles look up each half of the cube in its own copy of the table
+    const __m256i low = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) vector));
+    const __m256i high = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) (vector + 16)));
+    const __m256i orientations = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) (vector + 32)));
+    const __m256i sixteen = _mm256_set1_epi8(16);
+    const __m256i seven = _mm256_set1_epi8(7);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i cubies = _mm256_set_epi32(0, 0, 0, -1, -1, -1, -1, -1);
+
+    __m256i position = _mm256_and_si256(_mm256_srli_epi16(cube, 3),
+                                        _mm256_set1_epi8(0x1F));
+
+    __m256i ishigh = _mm256_cmpeq_epi8(_mm256_and_si256(position, sixteen),
+                                       sixteen);
+    __m256i moved = _mm256_blendv_epi8(_mm256_shuffle_epi8(low, position),
+                                       _mm256_shuffle_epi8(high, position),
+                                       ishigh);
+
+    __m256i onface = _mm256_slli_epi16(_mm256_and_si256(moved, one), 3);
+    __m256i orientation = _mm256_or_si256(_mm256_and_si256(cube, seven),
+                                          onface);
+    orientation = _mm256_shuffle_epi8(orientations, orientation);
+
+    __m256i turned = _mm256_or_si256(_mm256_andnot_si256(seven, moved),
+                                     orientation);
+    return _mm256_and_si256(turned, cubies);
+};
+
+
+/**
+  * Applies a move to many cubes with SSSE3
+  * @param 'in'   : cubes to be turned
+  * @param 'out'  : array where the turned cubes are stored (may be 'in')
+  * @param 'n'    : number of cubes
+  * @param 'm'    : move (face*3 + times - 1)
+  */
+
+__attribute__((target("ssse3")))
+void Rubik::turnSSSE3(const Rubik *in, Rubik *out, int n, int m) {
+    const unsigned char *vector = Rubik::vectorTurns[m];
+    //Only the first 4 bytes of the second half are cubies
+    const __m128i cubies = _mm_set_epi32(0, 0, 0, -1);
+
+    int k;
+    for (k = 0; k < n; k++) {
+        const __m128i *cube = (const __m128i *) in[k].cubies;
+        __m128i first = vectorTurnSSSE3(_mm_loadu_si128(cube), vector);
+        __m128i second = vectorTurnSSSE3(_mm_loadu_si128(cube + 1), vector);
+
+        _mm_storeu_si128((__m128i *) out[k].cubies, first);
+        _mm_storeu_si128((__m128i *) out[k].cubies + 1,
+                         _mm_and_si128(second, cubies));
+    }
+};
+
+
+/**
+  * Gets the 18 successors of a cube with SSSE3
+  * @param 'in'       : cube
+  * @param 'children' : array where the 18 successors are stored
+  */
+
+__attribute__((target("ssse3")))
+void Rubik::expandSSSE3(const Rubik *in, Rubik *children) {
+    const __m128i cubies = _mm_set_epi32(0, 0, 0, -1);
+    __m128i first = _mm_loadu_si128((const __m128i *) in->cubies);
+    __m128i second = _mm_loadu_si128((const __m128i *) in->cubies + 1);
+
+    int m;
+    for (m = 0; m < 18; m++) {
+        const unsigned char *vector = Rubik::vectorTurns[m];
+        __m128i *child = (__m128i *) children[m].cubies;
+        _mm_storeu_si128(child, vectorTurnSSSE3(first, vector));
+        _mm_storeu_si128(child + 1, _mm_and_si128(
+            vectorTurnSSSE3(second, vector), cubies));
+    }
+};
+
+
+/**
+  * Applies a move to many cubes with AVX2
+  * @param 'in'   : cubes to be turned
+  * @param 'out'  : array where the turned cubes are stored (may be 'in')
+  * @param 'n'    : number of cubes
+  * @param 'm'    : move (face*3 + times - 1)
+  */
+
+__attribute__((target("avx2")))
+void Rubik::turnAVX2(const Rubik *in, Rubik *out, int n, int m) {
+    const unsigned char *vector = Rubik::vectorTurns[m];
+
+    int k;
+    for (k = 0; k < n; k++) {
+        __m256i cube = _mm256_loadu_si256((const __m256i *) in[k].cubies);
+        _mm256_storeu_si256((__m256i *) out[k].cubies,
+                            vectorTurnAVX2(cube, vector));
+    }
+};
+
+
+/**
+  * Gets the 18 successors of a cube with AVX2
+  * @param 'in'       : cube
+  * @param 'children' : array where the 18 successors are stored
+  */
+
+__attribute__((target("avx2")))
+void Rubik::expandAVX2(const Rubik *in, Rubik *children) {
+    __m256i cube = _mm256_loadu_si256((const __m256i *) in->cubies);
+
+    int m;
+    for (m = 0; m < 18; m++) {
+        _mm256_storeu_si256((__m256i *) children[m].cubies,
+                            vectorTurnAVX2(cube, Rubik::vectorTurns[m]));
+    }
+};
+
+#else
+
+/**
+  * Without x86 vectors every kernel is the scalar one
+  */
+
+void Rubik::turnSSSE3(const Rubik *in, Rubik *out, int n, int m) {
+    Rubik::turnScalar(in, out, n, m);
+};
+
+void Rubik::expandSSSE3(const Rubik *in, Rubik *children) {
+    Rubik::expandScalar(in, children);
+};
+
+void Rubik::turnAVX2(const Rubik *in, Rubik *out, int n, int m) {
+    Rubik::turnScalar(in, out, n, m);
+};
+
+void Rubik::expandAVX2(const Rubik *in, Rubik *children) {
+    Rubik::expandScalar(in, children);
+};
+
+#endif
+
+
+/**
+  * Turns a single cubie
+  * @param 'face'    :     face to be moved
+  * @param 'times'   :     times the face is gonna be moved (1,2,3)
+  * @param 'cubie'   :     cubie
+  * @return The cubie after the turn
+  */
+
+unsigned char Rubik::turnCubie(int face, int times, unsigned char cubie) {
+    return Rubik::turns[face*3 + times - 1][cubie];
+};
 
 
 /**
   * Turns 90 degrees the left face clockwise
+  * @param 'cubie' : cubie
+  * @return The cubie after the turn
   */
 
-void Rubik::turnLeft() { 
+unsigned char Rubik::turnLeft(unsigned char cubie) {
     //Look up for cubies that are in positions of the left face
-    int i;
-    for (i = 0; i < 20; i++) {
-        if (this->getPosition(i) < 8) {
-            this->setCubie(i, this->swapYZ(this->getCubie(i))); //swap in situ 
-            int newposition = (this->getPosition(i) + 6) % 8;
-            this->changePositionTo(i, newposition);
-        }
+    int position = cubie >> 3;
+    if (position < 8) {
+        cubie = Rubik::swapYZ(cubie);  //swap in situ
+        cubie = Rubik::changePositionTo(cubie, (position + 6) % 8);
     }
+
+    return cubie;
 };
 
 
 /**
   * Turns 90 degrees the right face clockwise
+  * @param 'cubie' : cubie
+  * @return The cubie after the turn
   */
 
-void Rubik::turnRight() {
+unsigned char Rubik::turnRight(unsigned char cubie) {
     //Look up for cubies that are in positions of the right face
-    int i;
-    for (i = 0; i < 20; i++) {
-        if ((this->getPosition(i) >= 8) && (this->getPosition(i) < 16)) {
-            this->setCubie(i, this->swapYZ(this->getCubie(i))); //swap in situ 
-            int newposition = ((this->getPosition(i) + 6) % 8) + 8;
-            this->changePositionTo(i, newposition);
-        }
+    int position = cubie >> 3;
+    if ((position >= 8) && (position < 16)) {
+        cubie = Rubik::swapYZ(cubie);  //swap in situ
+        cubie = Rubik::changePositionTo(cubie, ((position + 6) % 8) + 8);
     }
+
+    return cubie;
 };
 
 
 /**
-  * Turn 90 degrees the top face clockwise
+  * Turns 90 degrees the top face clockwise
+  * @param 'cubie' : cubie
+  * @return The cubie after the turn
   */
 
-void Rubik::turnTop() {
+unsigned char Rubik::turnTop(unsigned char cubie) {
     //Look up for cubies that are in positions of the top face
-    int i;
-    for (i = 0; i < 20; i++) {
-        int newposition;
-        int position = this->getPosition(i);
-        switch (position) {
-            case 4 :  newposition = 6; 
-                      break;
-            case 5 :  newposition = 18;
-                      break;
-            case 6 :  newposition = 12;
-                      break;
-            case 12:  newposition = 14;
-                      break;
-            case 13:  newposition = 17;
-                      break;
-            case 14:  newposition = 4;
-                      break;
-            case 17:  newposition = 5;
-                      break;
-            case 18:  newposition = 13;
-                      break;
-            default:  newposition = -1;  //This cubie isnt in position
-                      break;
-        }
-        if (newposition != -1) {
-            this->setCubie(i, this->swapXY(this->getCubie(i))); //swap in situ
-            this->changePositionTo(i, newposition);
-        }
+    int newposition;
+    switch (cubie >> 3) {
+        case 4:  newposition = 6;
+                 break;
+        case 5:  newposition = 18;
+                 break;
+        case 6:  newposition = 12;
+                 break;
+        case 12: newposition = 14;
+                 break;
+        case 13: newposition = 17;
+                 break;
+        case 14: newposition = 4;
+                 break;
+        case 17: newposition = 5;
+                 break;
+        case 18: newposition = 13;
+                 break;
+        default: newposition = -1;  //This cubie isnt in position
+                 break;
     }
+    if (newposition != -1) {
+        cubie = Rubik::swapXY(cubie);  //swap in situ
+        cubie = Rubik::changePositionTo(cubie, newposition);
+    }
+
+    return cubie;
 };
 
 
 /**
   * Turns 90 degrees the bottom face clockwise
+  * @param 'cubie' : cubie
+  * @return The cubie after the turn
   */
 
-void Rubik::turnBottom() {
-    //Look up for cubies that are in positions of the top face
-    int i;
-    for (i = 0; i < 20; i++) {
-        int newposition;
-        int position = this->getPosition(i);
-        switch (position) {
-            case 0 : newposition = 2;
-                     break;
-            case 1 : newposition = 16;
-                     break;
-            case 2 : newposition = 8;
-                     break;
-            case 8 : newposition = 10;
-                     break;
-            case 9 : newposition = 19;
-                     break;
-            case 10: newposition = 0;
-                     break;
-            case 16: newposition = 9;
-                     break;
-            case 19: newposition = 1;
-                     break;
-            default: newposition = -1;
-                     break;
-        }
-        if (newposition != -1) {
-            this->setCubie(i, this->swapXY(this->getCubie(i))); //swap in situ
-            this->changePositionTo(i, newposition);
-        }
+unsigned char Rubik::turnBottom(unsigned char cubie) {
+    //Look up for cubies that are in positions of the bottom face
+    int newposition;
+    switch (cubie >> 3) {
+        case 0:  newposition = 2;
+                 break;
+        case 1:  newposition = 16;
+                 break;
+        case 2:  newposition = 8;
+                 break;
+        case 8:  newposition = 10;
+                 break;
+        case 9:  newposition = 19;
+                 break;
+        case 10: newposition = 0;
+                 break;
+        case 16: newposition = 9;
+                 break;
+        case 19: newposition = 1;
+                 break;
+        default: newposition = -1;  //This cubie isnt in position
+                 break;
     }
+    if (newposition != -1) {
+        cubie = Rubik::swapXY(cubie);  //swap in situ
+        cubie = Rubik::changePositionTo(cubie, newposition);
+    }
+
+    return cubie;
 };
 
 
 /**
   * Turns 90 degrees the front face clockwise
+  * @param 'cubie' : cubie
+  * @return The cubie after the turn
   */
 
-void Rubik::turnFront() {
-    //Look up for cubies that are in positions of the top face
-    int i;
-    for (i = 0; i < 20; i++) {
-        int newposition;
-        int position = this->getPosition(i);
-        switch (position) {
-            case 2 : newposition = 4;
-                     break;
-            case 3 : newposition = 17;
-                     break;
-            case 4 : newposition = 14;
-                     break;
-            case 8 : newposition = 2;
-                     break;
-            case 14: newposition = 8;
-                     break;
-            case 15: newposition = 16;
-                     break;
-            case 16: newposition = 3;
-                     break;
-            case 17: newposition = 15;
-                     break;
-            default: newposition = -1;
-                     break;
-        }
-        if (newposition != -1) {
-            this->setCubie(i, this->swapXZ(this->getCubie(i)));  //swap in situ
-            this->changePositionTo(i, newposition);
-        }
+unsigned char Rubik::turnFront(unsigned char cubie) {
+    //Look up for cubies that are in positions of the front face
+    int newposition;
+    switch (cubie >> 3) {
+        case 2:  newposition = 4;
+                 break;
+        case 3:  newposition = 17;
+                 break;
+        case 4:  newposition = 14;
+                 break;
+        case 8:  newposition = 2;
+                 break;
+        case 14: newposition = 8;
+                 break;
+        case 15: newposition = 16;
+                 break;
+        case 16: newposition = 3;
+                 break;
+        case 17: newposition = 15;
+                 break;
+        default: newposition = -1;  //This cubie isnt in position
+                 break;
+    }
+    if (newposition != -1) {
+        cubie = Rubik::swapXZ(cubie);  //swap in situ
+        cubie = Rubik::changePositionTo(cubie, newposition);
     }
+
+    return cubie;
 };
 
 
 /**
   * Turns 90 degrees the back face clockwise
+  * @param 'cubie' : cubie
+  * @return The cubie after the turn
   */
 
-void Rubik::turnBack() {
+unsigned char Rubik::turnBack(unsigned char cubie) {
     //Look up for cubies that are in positions of the back face
-    int i;
-    for (i = 0; i < 20; i++) {
-        int newposition;
-        int position = this->getPosition(i);
-        switch (position) {
-            case 0 : newposition = 10;
-                     break;
-            case 6 : newposition = 0;
-                     break;
-            case 7 : newposition = 19;
-                     break;
-            case 10: newposition = 12;
-                     break;
-            case 11: newposition = 18;
-                     break;
-            case 12: newposition = 6;
-                     break;
-            case 18: newposition = 7;
-                     break;
-            case 19: newposition = 11;
-                     break;
-            default: newposition = -1;  //This cubie isnt in position
-                     break;
-        }
-        if (newposition != -1) {
-            this->setCubie(i, this->swapXZ(this->getCubie(i))); //swap in situ
-            this->changePositionTo(i, newposition);
-        }
+    int newposition;
+    switch (cubie >> 3) {
+        case 0:  newposition = 10;
+                 break;
+        case 6:  newposition = 0;
+                 break;
+        case 7:  newposition = 19;
+                 break;
+        case 10: newposition = 12;
+                 break;
+        case 11: newposition = 18;
+                 break;
+        case 12: newposition = 6;
+                 break;
+        case 18: newposition = 7;
+                 break;
+        case 19: newposition = 11;
+                 break;
+        default: newposition = -1;  //This cubie isnt in position
+                 break;
     }
+    if (newposition != -1) {
+        cubie = Rubik::swapXZ(cubie);  //swap in situ
+        cubie = Rubik::changePositionTo(cubie, newposition);
+    }
+
+    return cubie;
 };
 
 
@@ -413,57 +748,43 @@ void Rubik::turnBack() {
   * Checks if cube is solved
   * @return True if cube is solved. False in any other case
   *
+  * The cube is compared with the goal a word at a time
+  *
   * @section Description
   * The cube is correctly solved when:
   *         Cubie          Position        Orientation
-  *     this->left[0]       00000            001             
-  *     this->left[1]       00001            001             
-  *     this->left[2]       00010            001
-  *     this->left[3]       00011            010
-  *     this->left[4]       00100            001
-  *     this->left[5]       00101            001
-  *     this->left[6]       00110            001
-  *     this->left[7]       00111            010
+  *     cubie 0              00000            001             
+  *     cubie 1              00001            001             
+  *     cubie 2              00010            001
+  *     cubie 3              00011            010
+  *     cubie 4              00100            001
+  *     cubie 5              00101            001
+  *     cubie 6              00110            001
+  *     cubie 7              00111            010
   *
-  *     this->Right[0]      01000            001             
-  *     this->Right[1]      01001            001             
-  *     this->Right[2]      01010            001
-  *     this->Right[3]      01011            010
-  *     this->Right[4]      01100            001
-  *     this->Right[5]      01101            001
-  *     this->Right[6]      01110            001
-  *     this->Right[7]      01111            010
+  *     cubie 8             01000            001             
+  *     cubie 9             01001            001             
+  *     cubie 10            01010            001
+  *     cubie 11            01011            010
+  *     cubie 12            01100            001
+  *     cubie 13            01101            001
+  *     cubie 14            01110            001
+  *     cubie 15            01111            010
   *
-  *     this->middle[0]     10000            001             
-  *     this->middle[1]     10001            001             
-  *     this->middle[2]     10010            001
-  *     this->middle[3]     10011            001
+  *     cubie 16            10000            001             
+  *     cubie 17            10001            001             
+  *     cubie 18            10010            001
+  *     cubie 19            10011            001
   */
 
 bool Rubik::isSolved() {
-    int i;
+    unsigned long long difference = 0;
 
-    for (i = 0; i < 20; i++) {
-        //check positions
-        if (this->getPosition(i) != i) {
-            return false;
-        }
+    int i;
+    for (i = 0; i < RUBIK_WORDS; i++)
+        difference = difference | (this->words[i] ^ Rubik::goal[i]);
 
-        //check orientations
-        if (i < 16) {
-            if ((this->getOrientation(i) != 2) && (i % 4 == 3))
-                return false;
-            
-            if ((this->getOrientation(i) != 1) && (i % 4 != 3))
-                return false;
-        }
-        else {
-            if (this->getOrientation(i) != 1)
-                return false;
-        }
-    }
-    
-    return true;
+    return difference == 0;
 };
 
 
@@ -473,34 +794,147 @@ bool Rubik::isSolved() {
   */
 
 list<Rubik> Rubik::getSucc() {
-    //Faces you can move
-    void (Rubik::*moves[6]) () = {
-        &Rubik::turnLeft,
-        &Rubik::turnRight,
-        &Rubik::turnTop,
-        &Rubik::turnBottom,
-        &Rubik::turnFront,
-        &Rubik::turnBack,
-    };
-
     list<Rubik> successors;
 
+    Rubik children[18];
+    this->expand(children);
+
     int i;
-    for (i = 0; i < 6; i++) {
-        Rubik newcube;
-        newcube = this->clone();  
+    for (i = 0; i < 18; i++)
+        successors.push_back(children[i]);
+    
+    return successors;
+};
+
+
+/**
+  * Returns the inverse configuration: the one that solves this cube when
+  * its moves are applied to the goal, so both are the same distance away
+  * from the goal.
+  *
+  * @section Description
+  *
+  * If cubie i is in position p, cubie p is in position i in the inverse.
+  * A corner is twisted 0, 1 or 2 thirds of a turn from its Z orientation,
+  * clockwise in corners with an odd position / 2 when it points to X, and
+  * the other way around in the even ones. The inverse twists cubie p the
+  * opposite way. An edge is flipped when it doesn't have the orientation
+  * of the cubie whose goal is its position, and the inverse flips cubie p
+  * the same way
+  * @return The inverse configuration
+  */
+
+Rubik Rubik::inverse() {
+    const unsigned char *goalcubies = (const unsigned char *) Rubik::goal;
+    Rubik inverse;
+
+    int i;
+    for (i = 0; i < 20; i++) {
+        int position = this->getPosition(i);
+        int orientation = this->getOrientation(i);
+        int newori;
+
+        if ((i < 16) && (i % 2 == 0)) {
+            //Twists: 0 for Z, 1 for X in odd corners and Y in even corners
+            bool odd = ((position / 2) % 2) != 0;
+            int twist = 0;
+            if (orientation == 4)
+                twist = odd ? 1 : 2;
+            else if (orientation == 2)
+                twist = odd ? 2 : 1;
+
+            bool newodd = ((i / 2) % 2) != 0;
+            twist = (3 - twist) % 3;
+            newori = 1;
+            if (twist == (newodd ? 1 : 2))
+                newori = 4;
+            else if (twist != 0)
+                newori = 2;
+        }
+        else {
+            //The other orientation of an edge is its maximum orientation
+            bool flipped = orientation != (goalcubies[position] & 7);
+            newori = goalcubies[i] & 7;
+            if (flipped)
+                newori = (i < 16) ? 4 : 2;
+        }
+
+        inverse.cubies[position] = (i << 3) | newori;
+    }
+
+    return inverse;
+};
 
-        (newcube.*moves[i])();          //turn 90 degrees
-        successors.push_back(newcube.clone());
 
-        (newcube.*moves[i])();          //turn 180 degrees
-        successors.push_back(newcube.clone());
+/**
+  * Checks that this Rubik's cube configuration can be solved
+  *
+  * @section Description
+  *
+  * Every position holds one cubie, corners are in corner positions and
+  * edges in edge positions, and every cubie has one of the orientations
+  * it can have there. Moves keep three more things: the permutations of
+  * the corners and of the edges are both even or both odd, the twists of
+  * the corners (see inverse) add up to a multiple of three, and an even
+  * number of edges are flipped
+  * @return True if the goal can be reached
+  */
+
+bool Rubik::isValid() {
+    const unsigned char *goalcubies = (const unsigned char *) Rubik::goal;
+    int cubie[20];       //Cubie in every position
+    int i;
+    for (i = 0; i < 20; i++)
+        cubie[i] = -1;
+
+    int twists = 0;
+    int flips = 0;
+    for (i = 0; i < 20; i++) {
+        int position = this->getPosition(i);
+        int orientation = this->getOrientation(i);
+        bool corner = (i < 16) && (i % 2 == 0);
+        if ((position >= 20) || (cubie[position] >= 0))
+            return false;
+        if (corner != ((position < 16) && (position % 2 == 0)))
+            return false;
+        cubie[position] = i;
+
+        if (corner) {
+            bool odd = ((position / 2) % 2) != 0;
+            if (orientation == 4)
+                twists += odd ? 1 : 2;
+            else if (orientation == 2)
+                twists += odd ? 2 : 1;
+            else if (orientation != 1)
+                return false;
+        }
+        else {
+            //An edge has the orientation of the goal or the maximum one
+            int max = (position < 16) ? 4 : 2;
+            if (orientation != (goalcubies[position] & 7)) {
+                if (orientation != max)
+                    return false;
+                flips++;
+            }
+        }
+    }
 
-        (newcube.*moves[i])();          //turn 270 or -90 degrees
-        successors.push_back(newcube);   
+    //Parity of each permutation, counting its cycles
+    int parity = 0;
+    bool seen[20] = {false};
+    for (i = 0; i < 20; i++) {
+        int length = 0;
+        int p = i;
+        while (!seen[p]) {
+            seen[p] = true;
+            p = cubie[p];
+            length++;
+        }
+        if (length > 0)
+            parity += length - 1;
     }
-    
-    return successors;
+
+    return (parity % 2 == 0) && (twists % 3 == 0) && (flips % 2 == 0);
 };
 
 
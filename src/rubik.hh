@@ -13,6 +13,13 @@
 
 #include <list>
 
+/*
+ * Bytes of a Rubik's cube: 20 cubies followed by zeros, so cubes are
+ * copied and compared a word at a time
+ */
+#define RUBIK_BYTES 32
+#define RUBIK_WORDS 4
+
 /*
  * Rubik's cube class
  */
@@ -21,12 +28,16 @@ class Rubik {
         /*
          * Leftmost 5 bits are for identification. Rightmost for orientation
          * Orientations is given by X,Y,Z tuple represented with 3 bits 
+         * Cubies 0 to 7 start in the left face, 8 to 15 in the right face
+         * and 16 to 19 in the middle face. The rest of the bytes are zero
          */
-        unsigned char left[8];   //0 to 7 cubie
-        unsigned char right[8];  //8 to 15 cubie
-        unsigned char middle[4]; //16 to 19 cubie
+        union {
+            unsigned char cubies[RUBIK_BYTES];
+            unsigned long long words[RUBIK_WORDS];
+        };
 
     public:
+        Rubik();
         void clean();
         void print();
         void transformToGoal();
@@ -35,24 +46,44 @@ class Rubik {
         void setCubie(int,unsigned char);
         unsigned char getCubie(int);
         void turn(int,int);
-        void turnLeft();
-        void turnRight();
-        void turnTop();
-        void turnBottom();
-        void turnFront();
-        void turnBack();
+        void expand(Rubik *);
+        static const char *kernelName();
         bool isSolved();
+        Rubik inverse();
+        bool isValid();
         std::list<Rubik> getSucc();
         bool isMaxOriented(int);
         void setMaxOrientation(int);
         void setMinOrientation(int);
         unsigned int getPosition(int);
         unsigned int getOrientation(int);
+        static unsigned char turnCubie(int,int,unsigned char);
     private:
-        void changePositionTo(int,int);
-        unsigned char swapXY(unsigned char);
-        unsigned char swapXZ(unsigned char);
-        unsigned char swapYZ(unsigned char);
+        static unsigned char turns[18][256];
+        static unsigned char vectorTurns[18][48];
+        static unsigned long long goal[RUBIK_WORDS];
+        static void (*kernel)(const Rubik *,Rubik *,int,int);
+        static void (*expander)(const Rubik *,Rubik *);
+        static const char *kernelname;
+        static const bool initialized;
+        static bool initializeTables();
+        static void chooseKernel();
+        static void turnScalar(const Rubik *,Rubik *,int,int);
+        static void turnSSSE3(const Rubik *,Rubik *,int,int);
+        static void turnAVX2(const Rubik *,Rubik *,int,int);
+        static void expandScalar(const Rubik *,Rubik *);
+        static void expandSSSE3(const Rubik *,Rubik *);
+        static void expandAVX2(const Rubik *,Rubik *);
+        static unsigned char changePositionTo(unsigned char,int);
+        static unsigned char turnLeft(unsigned char);
+        static unsigned char turnRight(unsigned char);
+        static unsigned char turnTop(unsigned char);
+        static unsigned char turnBottom(unsigned char);
+        static unsigned char turnFront(unsigned char);
+        static unsigned char turnBack(unsigned char);
+        static unsigned char swapXY(unsigned char);
+        static unsigned char swapXZ(unsigned char);
+        static unsigned char swapYZ(unsigned char);
 };
 
 #endif
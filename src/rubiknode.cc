@@ -12,6 +12,7 @@
 #include <string>
 #include "rubiknode.hh"
 #include "rubik.hh"
+#include "movepruning.hh"
 
 using namespace std;
 
@@ -31,6 +32,7 @@ void RubikNode::makeNode(Rubik state, RubikNode *parent,
     this->parent = parent;
     this->action = action;
     this->cost = cost;
+    this->pruning = 0;
 };
 
 
@@ -77,71 +79,31 @@ bool RubikNode::isGoal() {
   */
 
 RubikNode RubikNode::getChild(int child) {
-    //Left: ABC, Right: DEF, Top:GHI, Bottom:JKL, Front:MNO, Back:PQR
-    char moves[18] = {
-                'A', 'B', 'C',   //Moves for left face
-                'D', 'E', 'F',   //Moves for right face
-                'G', 'H', 'I',   //Moves for top face
-                'J', 'K', 'L',   //Moves for bottom face
-                'M', 'N', 'O',   //Moves for front face
-                'P', 'Q', 'R',   //Moves for back face
-    };
-
-    int excl1 = -1;     //Used for excluding moves
-    int excl2 = -1;     //Used for excluding moves
-
-    switch (this->action) {
-        case '\x00': break;    //root node case
-        case 'A': case 'B': case 'C':  excl1 = 0; excl2 = 0; break;     
-        case 'D': case 'E': case 'F':  excl1 = 0; excl2 = 1; break;  
-        case 'G': case 'H': case 'I':  excl1 = 2; excl2 = 2; break; 
-        case 'J': case 'K': case 'L':  excl1 = 2; excl2 = 3; break;
-        case 'M': case 'N': case 'O':  excl1 = 4; excl2 = 4; break;  
-        case 'P': case 'Q': case 'R':  excl1 = 4; excl2 = 5; break; 
-    };
-
-    int j;
-    int i = -1;
-    //Get the i-th child to this node!
-    for (j = 0; (j < 18) && (i < child); j++) {
-        if ((j/ 3) == excl1 || (j / 3) == excl2) {
-            continue;
-        }
-        i++;
-    }
-
-    j--;   //Because the the move would be when i == child
-    int face = j / 3;
-    int times = (j % 3) + 1;  
+    const MovePruning &pruning = MovePruning::tables();
+    const int *moves;
+    pruning.moves(this->pruning, &moves);
+    int j = moves[child];
 
     Rubik cube = this->state.clone();
-    cube.turn(face, times);
+    cube.turn(j / 3, (j % 3) + 1);
 
     RubikNode node;
-    node.makeNode(cube, this, moves[j], this->cost + 1);
+    node.makeNode(cube, this, 'A' + j, this->cost + 1);
+    node.pruning = pruning.next(this->pruning, j);
 
     return node;
 };
 
 
 /**
-  * Gets the number of valids children of this node
+  * Gets the number of valids children of this node: the moves that don't
+  * make a duplicate sequence of moves (see MovePruning)
   * @return The number of children
   */
 
 int RubikNode::numberOfChildren() {
-    int number = -1;
-    switch (this->action) {
-        case '\x00': number = 18; break;    //root node case
-        case 'A': case 'B': case 'C': number = 15; break;     
-        case 'D': case 'E': case 'F': number = 12; break;  
-        case 'G': case 'H': case 'I': number = 15; break; 
-        case 'J': case 'K': case 'L': number = 12; break;
-        case 'M': case 'N': case 'O': number = 15; break;  
-        case 'P': case 'Q': case 'R': number = 12; break; 
-    };
-
-    return number;
+    const int *moves;
+    return MovePruning::tables().moves(this->pruning, &moves);
 };
 
 
@@ -162,6 +124,29 @@ list<char> RubikNode::extractSolution() {
 };
 
 
+/**
+  * Returns the move that made this node from its parent
+  * @return Move between 0 and 17 (face*3 + times - 1), or -1 for the root
+  */
+
+int RubikNode::getMove() {
+    if (this->action == '\x00')
+        return -1;
+    return this->action - 'A';
+};
+
+
+/**
+  * Returns the state of the move pruning automaton after the path to this
+  * node
+  * @return State of the automaton (see MovePruning)
+  */
+
+int RubikNode::getPruning() {
+    return this->pruning;
+};
+
+
 /**
   * Returns the cost of the path to this node
   * @return The cost of the path
@@ -23,6 +23,7 @@ class RubikNode {
         RubikNode *parent;
         char action;
         int cost;
+        int pruning;       //State of the move pruning automaton
 
     public:
         void makeNode(Rubik,RubikNode *,char,int);
@@ -31,6 +32,8 @@ class RubikNode {
         RubikNode getChild(int);
         int numberOfChildren();
         std::list<char> extractSolution(); 
+        int getMove();
+        int getPruning();
         int getCost();
         Rubik getState();
 };
@@ -9,639 +9,1405 @@
   */
 
 #include <list>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "rubikpd.hh"
+#include "movetables.hh"
+#include "symmetry.hh"
 #include "utils.hh"
 #include "rubik.hh"
 
 using namespace std;
 
+/*
+ * States of a shared memory segment of pattern databases
+ */
+#define SHM_READY   0    //Published, and its files didn't change
+#define SHM_MISSING 1    //There is no segment of that name
+#define SHM_PENDING 2    //Another process is still publishing it
+#define SHM_STALE   3    //Of no use: another version, or older files
+#define SHM_EMPTY   4    //Created, but its header isn't written yet
+
 
 /**
-  * Returns the maximum value between the three pattern databases
-  * @param 'cube'  :  state
-  * @return The maximum value between the three paterrn databases
+  * Writes the name of the file of edges1 with k edges: edges1.pdb for six
+  * edges, edges1_7.pdb or edges1_8.pdb for seven or eight
+  * @param 'k'    : number of edges
+  * @param 'name' : where the name is stored (at least 16 chars)
   */
 
-int Rubikpd::heuristic(Rubik cube) {
-    int rankc = this->rankC(cube.clone());
-    int ranke1 = this->rankE(1, cube.clone());
-    int ranke2 = this->rankE(2, cube.clone());
+static void edgesFile(int k, char *name) {
+    if (k == 6)
+        sprintf(name, "edges1.pdb");
+    else
+        sprintf(name, "edges1_%d.pdb", k);
+};
 
-    int hcorners = this->corners[rankc];
-    int he1 = this->edges1[ranke1];
-    int he2 = this->edges2[ranke2];
 
-    //Get maximum value
-    
-    int h = max(hcorners, he1);
-    h = max(h, he2);
+/**
+  * Builds the move tables once the pattern databases are loaded. Searches
+  * move the indexes with them, so the first search doesn't build them
+  */
 
-    return h;
+static void buildMoveTables() {
+    MoveTables::tables();
 };
 
 
 /**
-  * Initializes corners, edges1, and edges2 by reading binary files
-  * @param 'c' :  file pointer to binary file of corners 
-  * @param 'e1'  :  file pointer to binary file of edges1
-  * @param 'e2'  :  file pointer to binary file of edges2
+  * Reads the size, modification time and inode of a file
+  * @param 'table' : table whose source file is read, and where they are
+  *                  stored
+  * @return True if the file exists. False in any other case
   */
 
-void Rubikpd::initializeAllWithFiles() {
-    printf("\nInitializing pattern databases from files\n\n");
-    this->initializeCornersWithFile();
-    this->initializeEdgesWithFile(1);
-    this->initializeEdgesWithFile(2);
+static bool stampFile(ShmTable *table) {
+    struct stat st;
+    if (stat(table->source, &st) != 0)
+        return false;
+
+    table->size = st.st_size;
+    table->modified = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    table->inode = st.st_ino;
+    return true;
 };
 
 
 /**
-  * Initializes corners by reading corners.bin (binary file)
+  * Says if the source file of a table changed after the segment was
+  * published. A file that can't be read any more is taken as changed
+  * @param 'table' : table of the segment
+  * @return True if the file was removed, replaced or written again
   */
 
-void Rubikpd::initializeCornersWithFile() {
-    printf("----Initializing corners\n");
-    FILE *fp;
-    fp = fopen("corners.bin", "rb");
+static bool changedFile(const ShmTable &table) {
+    ShmTable now = table;
+    if (!stampFile(&now))
+        return true;
+
+    return (now.size != table.size) || (now.modified != table.modified) ||
+           (now.inode != table.inode);
+};
 
-    int i;
-    for (i = 0; i < 264539520; i++) {
-        int x;
-        fread(&x, sizeof(int), 1, fp);
-        this->corners[i] = x;
-    }
 
-    fclose(fp);
+/**
+  * Records the file a table is about to be loaded from, so that a segment
+  * published later names that file (processes that attach can run in
+  * other directories, so the path is absolute)
+  * @param 'file'  : name of the file
+  * @param 'table' : where the path, size, modification time and inode are
+  *                  stored
+  */
+
+static void recordFile(const char *file, ShmTable *table) {
+    if ((realpath(file, table->source) == NULL) || !stampFile(table))
+        table->source[0] = '\0';
 };
 
 
 /**
-  * Initializes one array of edges by reading edges1.bin 
-  * if table = 1, or edges2.bin if table == 2 
-  * @param 'table' : 1 for edges1, 2 for edges2
+  * Reads the header of a shared memory segment and says what state it is
+  * in. The publisher sizes the segment, writes the header with its pid,
+  * then the tables, and then sets ready. A segment that isn't ready is
+  * stale once its publisher is gone, and one without a header once it is
+  * SHM_WAIT seconds old
+  * @param 'fd'     : descriptor of the segment
+  * @param 'header' : where the header is stored
+  * @param 'reason' : where the reason is stored, when it isn't ready
+  * @return SHM_READY, SHM_EMPTY, SHM_PENDING or SHM_STALE
   */
 
-void Rubikpd::initializeEdgesWithFile(int table) {
-    printf("----Initializing edges%d\n",table);
-    unsigned char *edges[2] = {this->edges1, this->edges2}; 
-    int t = table - 1;  //index of edges
+static int inspectSegment(int fd, ShmHeader *header, const char **reason) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        *reason = "can't be read";
+        return SHM_STALE;
+    }
+    void *map = MAP_FAILED;
+    if (st.st_size >= (off_t) sizeof(ShmHeader))
+        map = mmap(NULL, sizeof(ShmHeader), PROT_READ, MAP_SHARED, fd, 0);
+    bool empty = (map == MAP_FAILED);
+    if (!empty) {
+        memcpy(header, map, sizeof(ShmHeader));
+        header->ready = __atomic_load_n(&((ShmHeader *) map)->ready,
+                                        __ATOMIC_ACQUIRE);
+        munmap(map, sizeof(ShmHeader));
+        empty = !header->ready && (header->magic[0] == '\0');
+    }
+    if (empty) {
+        *reason = "was created but never published";
+        return (time(NULL) - st.st_ctime >= SHM_WAIT) ? SHM_STALE : SHM_EMPTY;
+    }
+    if ((memcmp(header->magic, "RUBIKSHM", 8) != 0) ||
+        (header->version != SHM_VERSION)) {
+        *reason = "was published by another version";
+        return SHM_STALE;
+    }
+    if (!header->ready && (kill(header->publisher, 0) != 0) &&
+        (errno == ESRCH)) {
+        *reason = "was left by a process that died publishing it";
+        return SHM_STALE;
+    }
+    if (!header->ready) {
+        *reason = "is still being published";
+        return SHM_PENDING;
+    }
+    if ((header->edges < 6) || (header->edges > EDGES_MAX)) {
+        *reason = "is not a segment of pattern databases";
+        return SHM_STALE;
+    }
 
-    FILE *fp;
-    if (table == 1) 
-        fp = fopen("edges1.bin", "rb");
-    else 
-        fp = fopen("edges2.bin", "rb");
+    int t;
+    for (t = 0; t < 2; t++) {
+        const ShmTable &table = header->tables[t];
+        header->tables[t].source[PATH_MAX - 1] = '\0';
+        if (table.offset + table.length > (unsigned long long) st.st_size) {
+            *reason = "is truncated";
+            return SHM_STALE;
+        }
+        if (changedFile(table)) {
+            *reason = "is older than the files of the tables";
+            return SHM_STALE;
+        }
+    }
 
-    int i;
-    for (i = 0; i < 42577920; i++) {
-        int x;
-        fread(&x, sizeof(int), 1, fp);
-        edges[t][i] = x;
+    return SHM_READY;
+};
+
+
+/**
+  * Opens a shared memory segment of pattern databases read-only. A segment
+  * that another process is publishing is waited for, at most SHM_WAIT
+  * seconds
+  * @param 'name'   : name of the segment
+  * @param 'fd'     : where the descriptor is stored, when it is ready
+  * @param 'header' : where the header is stored
+  * @param 'reason' : where the reason is stored, when it isn't ready
+  * @return SHM_READY, SHM_MISSING, SHM_STALE, or SHM_EMPTY or SHM_PENDING
+  *         if it is still being published
+  */
+
+static int openSegment(const char *name, int *fd, ShmHeader *header,
+                       const char **reason) {
+    chrono::steady_clock::time_point deadline =
+        chrono::steady_clock::now() + chrono::seconds(SHM_WAIT);
+    bool waiting = false;
+    while (true) {
+        *fd = shm_open(name, O_RDONLY, 0);
+        if (*fd < 0) {
+            *reason = "doesn't exist";
+            return SHM_MISSING;
+        }
+
+        int state = inspectSegment(*fd, header, reason);
+        if (state == SHM_READY)
+            return state;
+        close(*fd);
+        if (((state != SHM_PENDING) && (state != SHM_EMPTY)) ||
+            (chrono::steady_clock::now() >= deadline))
+            return state;
+
+        if (!waiting)
+            fprintf(stderr, "Waiting for %s to be published\n", name);
+        waiting = true;
+        this_thread::sleep_for(chrono::milliseconds(10));
     }
+};
 
-    fclose(fp);
+/**
+  * Makes pattern databases with empty tables
+  */
+
+Rubikpd::Rubikpd() {
+    this->edges = 6;
+    this->wanted = 2;
+    this->chooseLookups();
+    this->sources[0].source[0] = '\0';
+    this->sources[1].source[0] = '\0';
 };
 
 
 /**
-  * Initializes corners, edges1, edges2
+  * Sets the number of lookups of edges1 made for every state. The first
+  * two are edges1 and edges2, and every other one looks up another set of
+  * edges turned to edges1 by a symmetry (see Symmetries::edgesLookups).
+  * More lookups give larger values, and fewer nodes, for more time per
+  * node. There are 8 lookups of six edges, 16 of seven and 4 of eight
+  * @param 'n' : number of edge lookups (at least 1, 2 by default)
   */
 
-void Rubikpd::initializeAll() {
-    printf("\nInitializing pattern databases\n\n");
-    this->initializeCorners();
-    this->initializeEdges(1);  //edges1  
-    this->initializeEdges(2);  //edges2
+void Rubikpd::setLookups(int n) {
+    this->wanted = max(n, 1);
+    this->chooseLookups();
 };
 
 
 /**
-  * Initializes pattern database of corner permutations 
+  * Returns the number of lookups made for every state
+  * @return Number of lookups, the corners one included
   */
 
-void Rubikpd::initializeCorners() {
-    printf("----Initializing corners\n");
-    //initialize every cost in 255 
-    int i;
-    for (i = 0; i < 264539520; i++) 
-        this->corners[i] = '\xFF';  //255
+int Rubikpd::getLookups() const {
+    return this->lookups + 1;
+};
 
-    Rubik goalcube;
-    goalcube.transformToGoal();
-    int goal = this->rankC(goalcube);
-    this->corners[goal] = 0;
 
-    list<int> open;   //open queue
-    open.push_back(goal);
-    
-    while (!open.empty()) {
-        int parent = open.front();        //top
-        open.pop_front();                 //pop 
+/**
+  * Returns the number of edges of the edge patterns
+  * @return Number of edges of edges1 (6, 7 or 8)
+  */
 
-        Rubik cube = this->unrankC(parent);
-        list<Rubik> s = cube.getSucc();    //Successors
+int Rubikpd::getEdges() const {
+    return this->edges;
+};
 
-        for (list<Rubik>::iterator it = s.begin(); it != s.end(); it++) {
-            int child = this->rankC(*it);
 
-            //Already closed or in open queue
-            if (this->corners[child] != 255)  
-                continue;
-            
-            this->corners[child] = this->corners[parent] + 1;
-            open.push_back(child);
-        }
-    }
+/**
+  * Chooses the symmetries of the edge lookups for the current number of
+  * edges, up to the number asked for by setLookups
+  */
+
+void Rubikpd::chooseLookups() {
+    int symmetries[SYMMETRIES];
+    int n = Symmetries::tables().edgesLookups(this->edges, symmetries);
+
+    this->symmetries[0] = 0;    //Corners
+    int t;
+    for (t = 0; t < n; t++)
+        this->symmetries[t + 1] = symmetries[t];
+    this->lookups = min(this->wanted, n);
+};
+
+
+/**
+  * Returns the maximum value between the lookups of the pattern databases
+  * (corners, and edges1 through every symmetry chosen by setLookups), for
+  * the state and for its inverse when the tables keep exact costs. States
+  * are moved to the entry of their symmetry class before each lookup
+  * @param 'cube'  :  state
+  * @return The maximum value between the lookups, or -1 (see values)
+  */
+
+int Rubikpd::heuristic(Rubik cube) const {
+    int h[PDB_LOOKUPS];
+    int hmax = this->values(cube, h);
+    if (this->hasDual())
+        hmax = max(hmax, this->dual(cube));
+    return hmax;
+};
+
+
+/**
+  * Returns the maximum value between the lookups for the inverse of a
+  * state. The inverse is as far from the goal as the state,
+  * so this is another lower bound, though it can't be moved along with the
+  * state by the move tables: the inverse is ranked at every node
+  * @param 'cube'  :  state
+  * @return The maximum value between the lookups for the inverse of the
+  *         state
+  */
+
+int Rubikpd::dual(Rubik cube) const {
+    long index[PDB_LOOKUPS];
+    this->indexes(cube.inverse(), index);
+    return this->dual(index);
+};
+
+
+/**
+  * Returns the maximum value between the lookups for the inverse of a
+  * state, already ranked
+  * @param 'index' :  index of the inverse in each table (see indexes)
+  * @return The maximum value between the lookups for the inverse
+  */
+
+int Rubikpd::dual(const long *index) const {
+    long entry[PDB_LOOKUPS];
+    this->entries(index, entry);
+    return this->lookupDual(entry);
+};
+
+
+/**
+  * Returns the maximum value between the lookups for the inverse of a
+  * state, from the entries that keep its costs
+  * @param 'entry' :  entry of the inverse in each table (see entries)
+  * @return The maximum value between the lookups for the inverse
+  */
+
+int Rubikpd::lookupDual(const long *entry) const {
+    int hmax = 0;
+    int t;
+    for (t = 0; t <= this->lookups; t++)
+        hmax = max(hmax, this->table(t)->get(entry[t]));
+    return hmax;
+};
+
+
+/**
+  * Says if dual lookups can be made. Tables that keep costs mod 3 need the
+  * exact cost of a neighbor, and the inverse of a neighbor of a state is
+  * not a neighbor of the inverse in the tables
+  * @return True if every table keeps exact costs. False in any other case
+  */
+
+bool Rubikpd::hasDual() const {
+    return !this->corners.isMod3() && !this->edges1.isMod3();
+};
+
+
+/**
+  * Gets the exact cost of a state in each pattern database. Tables that
+  * keep costs mod 3 need a walk down to the goal, so this is meant for
+  * the root of a search
+  * @param 'cube'  :  state
+  * @param 'h'     :  array where the cost in each table is stored
+  * @return The maximum value between the lookups, or -1 if a table that
+  *         keeps costs mod 3 doesn't lead to the goal
+  */
+
+int Rubikpd::values(Rubik cube, int *h) const {
+    long index[PDB_LOOKUPS];
+    this->indexes(cube, index);
+    return this->values(index, h);
+};
+
+
+/**
+  * Gets the exact cost of a state in each pattern database, given the
+  * exact costs of a neighbor of the state (its parent in the search)
+  * @param 'cube'   :  state
+  * @param 'parent' :  cost of the neighbor in each table
+  * @param 'h'      :  array where the cost in each table is stored
+  * @return The maximum value between the lookups
+  */
+
+int Rubikpd::values(Rubik cube, const int *parent, int *h) const {
+    long index[PDB_LOOKUPS];
+    this->indexes(cube, index);
+    return this->values(index, parent, h);
+};
 
-    //Printing to binary file corners.bin
-    FILE *fp;
-    fp = fopen("corners.bin","wb");
 
-    for (i = 0; i < 264539520; i++) {
-        int x = this->corners[i];
-        fwrite(&x, sizeof(int), 1, fp);
+/**
+  * Gets the exact cost of a state in each pattern database from its
+  * indexes in the tables. Tables that keep costs mod 3 need a walk down
+  * to the goal, so this is meant for the root of a search
+  * @param 'index' :  index of the state in each table
+  * @param 'h'     :  array where the cost in each table is stored
+  * @return The maximum value between the lookups, or -1 if a table that
+  *         keeps costs mod 3 doesn't lead to the goal
+  */
+
+int Rubikpd::values(const long *index, int *h) const {
+    int hmax = 0;
+    int t;
+    for (t = 0; t <= this->lookups; t++) {
+        if (this->table(t)->isMod3())
+            h[t] = this->descend(t, index[t]);
+        else
+            h[t] = this->table(t)->get(this->entry(t, index[t]));
+        if (h[t] < 0)
+            return -1;
+        hmax = max(hmax, h[t]);
     }
 
-    fclose(fp); 
+    return hmax;
+};
+
+
+/**
+  * Gets the exact cost of a state in each pattern database from its
+  * indexes in the tables, given the exact costs of a neighbor of the state
+  * (its parent in the search). Costs kept mod 3 are recovered from the
+  * parent's costs because the cost of two neighbors differ by at most one
+  * @param 'index'  :  index of the state in each table
+  * @param 'parent' :  cost of the neighbor in each table
+  * @param 'h'      :  array where the cost in each table is stored
+  * @return The maximum value between the lookups
+  */
 
+int Rubikpd::values(const long *index, const int *parent, int *h) const {
+    long entry[PDB_LOOKUPS];
+    this->entries(index, entry);
+    return this->lookup(entry, parent, h);
 };
 
 
 /**
-  * Initializes pattern database of edge permutations 
-  * @param 'table' : 1 for edges1, 2 for edges2
+  * Gets the exact cost of a state in each pattern database from the
+  * entries that keep them, given the exact costs of a neighbor of the
+  * state (see values)
+  * @param 'entry'  :  entry of the state in each table (see entries)
+  * @param 'parent' :  cost of the neighbor in each table
+  * @param 'h'      :  array where the cost in each table is stored
+  * @return The maximum value between the lookups
   */
 
-void Rubikpd::initializeEdges(int table) {
-    printf("----Initializing edges%d\n",table);
-    unsigned char *edges[2] = {this->edges1, this->edges2}; 
-    int t = table - 1;  //index of edges
+int Rubikpd::lookup(const long *entry, const int *parent, int *h) const {
+    int hmax = 0;
+    int t;
+    for (t = 0; t <= this->lookups; t++) {
+        const PdbTable *table = this->table(t);
+        int value = table->get(entry[t]);
+
+        if (table->isMod3()) {
+            //0: same cost, 1: one more, 2: one less
+            int step = (value - (parent[t] % 3) + 3) % 3;
+            value = parent[t];
+            if (step == 1)
+                value++;
+            else if (step == 2)
+                value--;
+        }
 
-    //Default values
-    int i;
-    for (i = 0; i < 42577920; i++) {
-        edges[t][i] = '\xFF';   //255
+        h[t] = value;
+        hmax = max(hmax, value);
     }
 
-    Rubik goalcube;
-    goalcube.transformToGoal();
-    int goal = this->rankE(table, goalcube);
+    return hmax;
+};
 
-    edges[t][goal] = 0;
 
-    list<int> open;     //open queue for edges1
-    open.push_back(goal);
+/**
+  * Ranks a Rubik's cube in every table. A search only needs this for its
+  * root: the indexes of the other nodes come from moveIndexes
+  * @param 'cube'  :  state
+  * @param 'index' :  array where the index in each table is stored
+  */
 
-    while (!open.empty()) {
-        int parent = open.front();  //top
-        open.pop_front();           //pop
+void Rubikpd::indexes(Rubik cube, long *index) const {
+    int t;
+    for (t = 0; t <= this->lookups; t++)
+        index[t] = this->index(t, cube);
+};
 
-        //Get cube
-        Rubik cube = this->unrankE(table, parent);
 
-        list<Rubik> s = cube.getSucc();  //successors
+/**
+  * Gets the indexes of a successor from the indexes of a state, with the
+  * move tables
+  * @param 'index' :  index of the state in each table
+  * @param 'm'     :  move (face*3 + times - 1)
+  * @param 'child' :  array where the index of the successor is stored
+  */
 
-        for (list<Rubik>::iterator it = s.begin(); it != s.end(); it++) {
-            int child = this->rankE(table, (*it));
+void Rubikpd::moveIndexes(const long *index, int m, long *child) const {
+    const MoveTables &moves = MoveTables::tables();
+    child[0] = moves.moveCorners(index[0], m);
 
-            //Already close or in open queue
-            if (edges[t][child] != 255)
-                continue;
-            
-            edges[t][child] = edges[t][parent] + 1;
+    //Every edge lookup follows its own edges with the same table
+    int t;
+    for (t = 1; t <= this->lookups; t++)
+        child[t] = moves.moveEdges(this->edges, index[t], m);
+};
 
-            open.push_back(child);
+
+/**
+  * Gets the exact cost of a state in a table that keeps costs mod 3, by
+  * moving to a neighbor whose cost is one less until the pattern is solved.
+  * A corrupt table, or one built for other patterns, may have no such
+  * neighbor or lead nowhere, so the walk gives up after PATTERN_DEPTH_MAX
+  * moves
+  * @param 't'     :  0 for corners, or the edge lookup (see setLookups)
+  * @param 'i'     :  index of the state in the table
+  * @return The cost of the state in the table, or -1 if the walk doesn't
+  *         reach the goal
+  */
+
+int Rubikpd::descend(int t, long i) const {
+    const PdbTable *table = this->table(t);
+    Rubik goalcube;
+    goalcube.transformToGoal();
+    long goal = this->index(t, goalcube);
+
+    int cost = 0;
+    long current = i;
+    int value = table->get(this->entry(t, current));
+    while (current != goal) {
+        int lower = (value + 2) % 3;   //cost - 1 (mod 3)
+        long children[18];
+        this->successors(t, current, children);
+
+        int k;
+        for (k = 0; k < 18; k++) {
+            if (table->get(this->entry(t, children[k])) == lower) {
+                current = children[k];
+                break;
+            }
+        }
+        value = lower;
+        cost++;
+
+        if ((k == 18) || (cost > PATTERN_DEPTH_MAX)) {
+            fprintf(stderr, "The %s table doesn't lead to the goal: it is "
+                    "corrupt or doesn't match the patterns\n",
+                    (t == 0) ? "corners" : "edges1");
+            return -1;
         }
     }
 
-    //Printing to binary file edges1.bin or edges2.bin
-    FILE *fp;
-    if (table == 1) 
-        fp = fopen("edges1.bin","wb");
-    else
-        fp = fopen("edges2.bin","wb");
+    return cost;
+};
 
-    for (i = 0; i < 42577920; i++) {
-        int x = edges[t][i];
-        fwrite(&x, sizeof(int), 1, fp);
-    }
 
-    fclose(fp); 
+/**
+  * Ranks a Rubik's cube in one of the tables
+  * @param 't'     :  0 for corners, or the edge lookup (see setLookups)
+  * @param 'cube'  :  state
+  * @return Index of the state in the table
+  */
+
+long Rubikpd::index(int t, Rubik cube) const {
+    if (t == 0)
+        return this->rankC(cube);
+    return this->rankE(t, cube);
 };
 
 
 /**
-  * Ranks a Rubik's cube partly by taking only corners
-  * @param 'cube' : Rubik's cube configuration
-  * @return Ranked permutation (value between 0 and 264.539.519)
+  * Returns one of the tables
+  * @param 't'  :  0 for corners, or the edge lookup (see setLookups)
+  * @return Pointer to the table
   */
 
-int Rubikpd::rankC(Rubik cube) {
-    int x = this->rankCornersP(cube);     //Permutation of positions
-    int y = this->rankCornersO(cube);     //Permutation of orientations
+const PdbTable *Rubikpd::table(int t) const {
+    if (t == 0)
+        return &this->corners;
+    return &this->edges1;    //Every edge lookup is made in edges1
+};
 
-    return x*(pow(3,8)) + y;
+
+/**
+  * Returns one of the tables, to be modified
+  * @param 't'  :  0 for corners, or the edge lookup (see setLookups)
+  * @return Pointer to the table
+  */
+
+PdbTable *Rubikpd::table(int t) {
+    if (t == 0)
+        return &this->corners;
+    return &this->edges1;    //Every edge lookup is made in edges1
 };
 
 
 /**
-  * Ranks a Rubik's cube partly by taking only corner positions 
-  * It uses rankAux from utils.hh to rank a permutation of 
-  * integers into an integer
-  * @param 'cube' : Rubik's cube configuration
-  * @return Permutation of the corner positions (value between 0 and 40319)
+  * Gets the entry of a table that keeps the cost of a state
+  * @param 't'  :  0 for corners, or the edge lookup (see setLookups)
+  * @param 'i'  :  index of the state (see index)
+  * @return Entry of the state in table(t)
   */
 
-int Rubikpd::rankCornersP(Rubik cube) {
-    int positions[8];
-    int k = 0;
-    
-    //Transforms a Rubik's cube into a permutation of corners
-    int i;
-    for (i = 0; i < 16; i++) {
-        if (i % 2 == 0) {
-            positions[k] = (cube.getPosition(i)) / 2;
-            k++;
+long Rubikpd::entry(int t, long i) const {
+    if (t == 0)
+        return Symmetries::tables().reduceCorners(i);
+    return Symmetries::tables().turnEdges(this->symmetries[t], this->edges, i);
+};
+
+
+/**
+  * Gets a state whose cost is kept in an entry of a table
+  * @param 't'     :  0 for corners, 1 for edges1
+  * @param 'entry' :  entry of table(t)
+  * @return Index of the state (see index)
+  */
+
+long Rubikpd::state(int t, long entry) const {
+    if (t == 0)
+        return Symmetries::tables().cornersState(entry);
+    return entry;
+};
+
+
+/**
+  * Sets the cost of an entry that hasn't been reached yet, together with
+  * the other entries of the corners table that keep the same state
+  * @param 't'     :  0 for corners, 1 for edges1
+  * @param 'entry' :  entry of table(t)
+  * @param 'cost'  :  cost to store
+  * @return Number of entries this call set
+  */
+
+int Rubikpd::reach(int t, long entry, int cost) {
+    PdbTable *table = this->table(t);
+    int reached = 0;
+    if (table->claim(entry, cost))
+        reached++;
+
+    if (t == 0) {
+        long twins[SYMMETRIES];
+        int n = Symmetries::tables().cornersTwins(entry, twins);
+        int k;
+        for (k = 0; k < n; k++) {
+            if (table->claim(twins[k], cost))
+                reached++;
         }
     }
 
-    //Pre calculate inverse
-    int inverse[8];
-    for (i = 0; i < 8; i++)
-      inverse[positions[i]] = i;
+    return reached;
+};
 
-    return (rankAux(1, 8, positions, inverse));  //rank a sequence of integers
+
+/**
+  * Initializes corners and edges1 by mapping the files cornersym.pdb and
+  * edges1_8.pdb, edges1_7.pdb or edges1.pdb (or edges1.bin when there is no
+  * .pdb file), whichever has the most edges. Entries are
+  * read from the mapped pages on demand, so no table is copied into memory
+  * unless 'bits' asks for a packing the file doesn't have. Without
+  * cornersym.pdb, the full corners.pdb (or corners.bin) is reduced in memory
+  * @param 'bits' : bits per entry the tables must have in memory (8, 4,
+  *                 or 2 to keep costs mod 3), or 0 to use the files as they are
+  * @return True if the files could be mapped. False in any other case
+  */
+
+bool Rubikpd::initializeAllWithFiles(int bits) {
+    fprintf(stderr, "\nInitializing pattern databases from files\n\n");
+    if (!this->initializeCornersWithFile(bits))
+        return false;
+    if (!this->initializeEdgesWithFile(bits))
+        return false;
+    this->reportPages();
+    buildMoveTables();
+    return true;
 };
 
 
 /**
-  * Ranks a Rubik's cube partly by taking only corner orientations 
-  *
-  * @section Description
-  *
-  * There are 3 orientations X,Y,Z: 100, 010, 001
-  * And they are gonna be represent as 0,1, or 2
-  * That's why % 4 is used!
-  *
-  * @param 'cube' : Rubik's cube configuration
-  * @return Orientation permutations (value between 0 and 6560)
+  * Reads now every page of the tables that are served from mapped files,
+  * instead of the first time each page is looked up
   */
 
-int Rubikpd::rankCornersO(Rubik cube) {
-    int rank = 0;
-    int i;
-    
-    for (i = 0; i < 16; i++) {
-        if (i % 2 == 0) {
-            //represent orientations as 0,1, or 2
-            int orientation = cube.getOrientation(i) % 4;
-            rank = (rank*3) + orientation;
+void Rubikpd::prefetch() const {
+    this->corners.prefetch();
+    this->edges1.prefetch();
+};
+
+
+/**
+  * Gets the entries that keep the costs of a state, one for every lookup
+  * @param 'index' :  index of the state in each table (see indexes)
+  * @param 'entry' :  array where the entry in each table is stored
+  */
+
+void Rubikpd::entries(const long *index, long *entry) const {
+    int t;
+    for (t = 0; t <= this->lookups; t++)
+        entry[t] = this->entry(t, index[t]);
+};
+
+
+/**
+  * Asks the cache for the entries that keep the costs of a state, without
+  * waiting for them. A search asks for the entries of every sibling before
+  * looking any of them up, so that their misses overlap instead of coming
+  * one after the other
+  * @param 'entry' :  entry of the state in each table (see entries)
+  */
+
+void Rubikpd::prefetch(const long *entry) const {
+    int t;
+    for (t = 0; t <= this->lookups; t++)
+        this->table(t)->prefetch(entry[t]);
+};
+
+
+/**
+  * Publishes the tables in a named POSIX shared memory segment so that
+  * other processes can attach to them instead of loading their own copy.
+  * The tables of this process are then served from the segment too. If
+  * another process publishes the segment first, this one waits for it and
+  * attaches to it, and only a segment that is of no use (another version,
+  * older files, or left by a process that died publishing it) is
+  * replaced. The segment stays until it is removed (rm /dev/shm/name),
+  * and it records the files the tables were loaded from when they were,
+  * so that it is not used once they are built again
+  * @param 'name' : name of the segment ("/rubik")
+  * @return True if the tables are served from the segment. False in any
+  *         other case
+  */
+
+bool Rubikpd::publish(const char *name) {
+    ShmHeader header;
+    memset(&header, 0, sizeof(ShmHeader));
+    memcpy(header.magic, "RUBIKSHM", 8);
+    header.version = SHM_VERSION;
+    header.edges = this->edges;
+    header.publisher = getpid();
+
+    //The header takes the first block, then every table starts a new one
+    int bits[2];
+    size_t size = SHM_ALIGN;
+    int t;
+    for (t = 0; t < 2; t++) {
+        ShmTable *table = &header.tables[t];
+        if (this->sources[t].source[0] == '\0') {
+            fprintf(stderr, "Only tables loaded from files are published\n");
+            return false;
         }
+        *table = this->sources[t];
+
+        bits[t] = this->table(t)->bitsPerEntry();
+        if (bits[t] == 32)     //.bin files, whose costs fit in a byte
+            bits[t] = 8;
+        table->offset = size;
+        table->length = this->table(t)->imageSize(bits[t]);
+        size += (table->length + SHM_ALIGN - 1) / SHM_ALIGN * SHM_ALIGN;
     }
 
-    return rank;
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if ((fd < 0) && (errno == EEXIST)) {
+        //Another process published it, or is publishing it
+        ShmHeader other;
+        const char *reason;
+        int state = openSegment(name, &fd, &other, &reason);
+        if (state == SHM_READY) {
+            close(fd);
+            return this->attach(name);
+        }
+        if ((state == SHM_PENDING) || (state == SHM_EMPTY)) {
+            fprintf(stderr, "The shared memory segment %s %s\n", name,
+                    reason);
+            return false;
+        }
+
+        //Only a segment that is of no use is removed
+        if (state == SHM_STALE) {
+            fprintf(stderr, "Replacing the shared memory segment %s: it %s\n",
+                    name, reason);
+            shm_unlink(name);
+        }
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if ((fd < 0) || (ftruncate(fd, size) != 0)) {
+        fprintf(stderr, "Can't create the shared memory segment %s: %s\n",
+                name, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+            shm_unlink(name);
+        }
+        return false;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Can't map the shared memory segment %s: %s\n",
+                name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    adviseHugePages(map, size);
+
+    //Processes that attach meanwhile see a segment that isn't ready, and
+    //who publishes it
+    unsigned char *segment = (unsigned char *) map;
+    memcpy(segment, &header, sizeof(ShmHeader));
+
+    int kinds[2] = {PDB_CORNERS_SYM, PDB_EDGES1};
+    bool ok = true;
+    for (t = 0; (t < 2) && ok; t++)
+        ok = this->table(t)->writeImage(segment + header.tables[t].offset,
+                                        kinds[t], bits[t]);
+    __atomic_store_n(&((ShmHeader *) segment)->ready, ok, __ATOMIC_RELEASE);
+    munmap(map, size);
+
+    if (ok)
+        ok = this->mapSegment(fd, name, header);
+    close(fd);
+    if (!ok) {
+        shm_unlink(name);
+        return false;
+    }
+
+    fprintf(stderr, "Published the pattern databases in %s (%ld MB)\n", name,
+            (long) (size >> 20));
+    return true;
 };
 
 
 /**
-  * Unranks a permutation of corner cubies
-  * @param 'p' : integer value between 0 and 264.539.519
-  * @return Rubik's cube configuration with null values in edge cubies
+  * Serves the tables from a shared memory segment published by another
+  * process, read-only, instead of loading the files. A segment that is
+  * still being published is waited for (see SHM_WAIT)
+  * @param 'name' : name of the segment
+  * @return True if the segment exists, was published by this version, is
+  *         complete and its files didn't change. False in any other case
   */
 
-Rubik Rubikpd::unrankC(int p) {
-    int t = 6561;    //3^8
-    Rubik cube;  
-    cube.clean();
+bool Rubikpd::attach(const char *name) {
+    int fd;
+    ShmHeader header;
+    const char *reason;
+    if (openSegment(name, &fd, &header, &reason) != SHM_READY) {
+        fprintf(stderr, "The shared memory segment %s %s\n", name, reason);
+        return false;
+    }
 
-    Rubik positions = this->unrankCornersP(p / t);
-    Rubik orientations = this->unrankCornersO(p % t);
-    
-    int i;
-    for (i = 0; i < 20; i++) {
-        //Merge ID with orientation to get final cubie
-        unsigned char cubie = positions.getCubie(i) | orientations.getCubie(i);
-        cube.setCubie(i, cubie);
+    bool ok = this->mapSegment(fd, name, header);
+    close(fd);
+    if (!ok)
+        return false;
+
+    fprintf(stderr, "Attached to the pattern databases in %s\n", name);
+    buildMoveTables();
+    return true;
+};
+
+
+/**
+  * Maps the tables of a shared memory segment read-only
+  * @param 'fd'     : descriptor of the segment
+  * @param 'name'   : name of the segment
+  * @param 'header' : header of the segment
+  * @return True if both tables could be mapped. False in any other case
+  */
+
+bool Rubikpd::mapSegment(int fd, const char *name, const ShmHeader &header) {
+    this->edges = header.edges;
+    this->chooseLookups();
+
+    long entries[2];
+    entries[0] = Symmetries::tables().cornersEntries();
+    entries[1] = (long) MoveTables::edgesPositions(this->edges) << this->edges;
+    int kinds[2] = {PDB_CORNERS_SYM, PDB_EDGES1};
+
+    int t;
+    for (t = 0; t < 2; t++) {
+        PdbTable *table = this->table(t);
+        if (!table->mapRange(fd, name, header.tables[t].offset,
+                             header.tables[t].length, kinds[t], entries[t]))
+            return false;
     }
 
-    return cube;
+    this->reportPages();
+    return true;
 };
- 
+
 
 /**
-  * Gets a Rubik's cube configuration without orientations (only positions) 
-  * It uses unrankAux from utils.hh to unrank an intenger into
-  * a sequence of integers
-  * from an integer value between 0 and 40319 (ranked ID permutation)
-  * @param 'x' : permutation of corner positions represented as an int
-  * @return Rubik's cube configuration
+  * Writes to the standard error the pages that back each table, and the
+  * kernel that turns the cubes of the searches (see Rubik::kernelName)
   */
 
-Rubik Rubikpd::unrankCornersP(int x) {
-    Rubik cube;
-    cube.clean();
-    int identity[8] = {0,1,2,3,4,5,6,7};
-    int i;
+void Rubikpd::reportPages() const {
+    fprintf(stderr, "----Cubes turned with the %s kernel\n",
+            Rubik::kernelName());
+    char pages[64];
+    this->corners.describePages(pages);
+    fprintf(stderr, "----Pages of corners: %s\n", pages);
+    this->edges1.describePages(pages);
+    fprintf(stderr, "----Pages of edges1: %s\n", pages);
+};
 
-    unrankAux(0, 8, x, identity);   //Put in identity the unranked permutation
 
-    //Transform sequence into a Rubik's cube configuration 
-    for (i = 0; i < 8; i++) {
-        unsigned char cubie = identity[i]*2;
-        cubie = cubie << 3;
-        cube.setCubie(i*2, cubie);       //i*2 because these are corner cubies
+/**
+  * Initializes corners by mapping cornersym.pdb, or by reducing the full
+  * corners table
+  * @param 'bits' : bits per entry in memory, or 0 to use the file as it is
+  * @return True if the table could be loaded. False in any other case
+  */
+
+bool Rubikpd::initializeCornersWithFile(int bits) {
+    fprintf(stderr, "----Initializing corners\n");
+    long entries = Symmetries::tables().cornersEntries();
+
+    bool ok;
+    if (access("cornersym.pdb", F_OK) == 0) {
+        recordFile("cornersym.pdb", &this->sources[0]);
+        ok = this->corners.mapFile("cornersym.pdb", PDB_CORNERS_SYM, entries);
     }
+    else
+        ok = this->reduceCorners();
 
-    return cube;
+    if (ok && (bits != 0))
+        ok = this->corners.pack(bits);
+    return ok;
 };
 
 
 /**
-  * Gets a Rubik's cube configuration without positions (only orientations)
-  * from an integer value between 0 and 6560 (ranked orientation permutations)
-  * @param 'x' : permutation of corner orientations represented as an integer
-  * @return Rubik's cube configuration
+  * Initializes corners from the full table of every corner configuration
+  * in corners.pdb or corners.bin, keeping one entry per symmetry class.
+  * The entries keep the bits of the file, initializeCornersWithFile packs
+  * them
+  * @return True if the file could be mapped. False in any other case
   */
 
-Rubik Rubikpd::unrankCornersO(int x) {
-    Rubik cube;
-    cube.clean();
-    int y = x;
-    int i;
-    int k = 0;
+bool Rubikpd::reduceCorners() {
+    PdbTable full;
+    const char *file = "corners.bin";
+    if (access("corners.pdb", F_OK) == 0)
+        file = "corners.pdb";
+    recordFile(file, &this->sources[0]);
+    if (!full.mapFile(file, PDB_CORNERS, 264539520))
+        return false;
+
+    fprintf(stderr,
+            "        reducing the full table (./pdb writes cornersym.pdb)\n");
+    const Symmetries &symmetries = Symmetries::tables();
+    long entries = symmetries.cornersEntries();
+
+    //Ints of .bin files fit in a byte
+    int size = full.bitsPerEntry();
+    if (size == 32)
+        size = 8;
+    if (!this->corners.allocate(entries, size))
+        return false;
+
+    long e;
+    for (e = 0; e < entries; e++)
+        this->corners.set(e, full.get(symmetries.cornersState(e)));
+    return true;
+};
 
-    for (i = 7; i >= 0; i--) {
-        //calculate orientation of di with pure magic
-        int power = pow(3, i);
-        int di = y / power;     
-        y = y-(di*power);     
 
-        if (di == 0)
-            di = 4;    //di was oriented to X-axis, wich is 100 in Rubik class
+/**
+  * Initializes edges1 by mapping the file with the most edges among
+  * edges1_8.pdb, edges1_7.pdb and edges1.pdb (or edges1.bin). edges2 is
+  * looked up in edges1
+  * @param 'bits'  : bits per entry in memory, or 0 to use the file as it is
+  * @return True if the file could be mapped. False in any other case
+  */
 
-        unsigned char cubie = di; 
-        cube.setCubie(k*2, cubie);
-        k++;
+bool Rubikpd::initializeEdgesWithFile(int bits) {
+    char name[16];
+    int k = EDGES_MAX;
+    edgesFile(k, name);
+    while ((k > 6) && (access(name, F_OK) != 0)) {
+        k--;
+        edgesFile(k, name);
     }
 
-    return cube;
+    this->edges = k;
+    this->chooseLookups();
+    long entries = (long) MoveTables::edgesPositions(k) << k;
+    fprintf(stderr, "----Initializing edges1 (%d edges)\n", k);
+
+    if ((k == 6) && (access(name, F_OK) != 0))
+        sprintf(name, "edges1.bin");
+    recordFile(name, &this->sources[1]);
+    bool ok = this->edges1.mapFile(name, PDB_EDGES1, entries);
+
+    if (ok && (bits != 0))
+        ok = this->edges1.pack(bits);
+    return ok;
 };
 
 
 /**
-  * Ranks a Rubik's cube partly by taking only edges  (edges1)
-  * @param 'table' : Has what table is going to be used
-  * @param 'cube'  : Rubik's cube configuration
-  * @return Ranked permutation (value between 0 and 42.577.920)
+  * Initializes corners and edges1 and writes them to cornersym.pdb and
+  * edges1.pdb, edges1_7.pdb or edges1_8.pdb (edges2 is looked up in
+  * edges1). With more than one thread the two tables are built at the
+  * same time and the threads are split between them
+  * @param 'bits'    : bits per entry in memory and in the files (8, 4 or 2)
+  * @param 'layered' : true to build the tables one depth at a time by
+  *                    scanning them, false to use an open queue
+  * @param 'threads' : number of threads that scan the tables (at least 1)
+  * @param 'edges'   : number of edges of edges1 and edges2 (6, 7 or 8)
+  * @return True if both files could be written. False in any other case
   */
 
-int Rubikpd::rankE(int table, Rubik cube) {
-    int x = this->rankEdgesP(table, cube);     //Permutation of positions
-    int y = this->rankEdgesO(table, cube);     //Permutation of orientations
+bool Rubikpd::initializeAll(int bits, bool layered, int threads, int edges) {
+    printf("\nInitializing pattern databases\n\n");
+    this->edges = edges;
+
+    this->chooseLookups();
+    vector<thread> builders;
+    bool written[2];
+
+    //Edges1 is the larger table, it gets the odd thread
+    int shares[2] = {threads / 2, threads - threads / 2};
+
+    //Only corners and edges1 are kept
+    int t;
+    for (t = 0; t < 2; t++) {
+        if (layered && (threads > 1))
+            builders.push_back(thread(&Rubikpd::initializeLayered, this,
+                                      t, bits, shares[t], &written[t]));
+        else if (layered)
+            this->initializeLayered(t, bits, threads, &written[t]);
+        else if (t == 0)
+            written[t] = this->initializeCorners(bits);
+        else
+            written[t] = this->initializeEdges(bits);
+    }
 
-    return x*(pow(2,6)) + y;
+    for (t = 0; t < (int) builders.size(); t++)
+        builders[t].join();
+    this->reportPages();
+    return written[0] && written[1];
 };
 
 
 /**
-  * Ranks a Rubik's cube partly by taking only the positions of six edges 
-  * It uses rankAux from utils.hh to rank a permutation of 
-  * integers into an integer
-  *
-  * @param 'table' : Table we are ranking (1 for edges1, or 2 for edges2)
-  * @param 'cube'  : Rubik's cube configuration
-  * @return Permutation of positions (value between 0 and 665.279)
+  * Initializes a pattern database one depth at a time, without an open
+  * queue: every pass scans the table for the entries reached by the
+  * previous pass and expands them, so the only memory used is the table.
+  * Each pass is split in chunks that the threads take in turn
+  * @param 't'       : 0 for corners, 1 for edges1
+  * @param 'bits'    : bits per entry in memory and in the file (8, 4 or 2)
+  * @param 'threads' : number of threads that scan the table
+  * @param 'written' : where it is stored whether the file could be written
   */
 
-int Rubikpd::rankEdgesP(int table, Rubik cube) {
-    int positions[6];
+void Rubikpd::initializeLayered(int t, int bits, int threads, bool *written) {
+    const char *names[2] = {"corners", "edges1"};
+    char files[2][16] = {"cornersym.pdb", ""};
+    int kinds[2] = {PDB_CORNERS_SYM, PDB_EDGES1};
+    long positions = MoveTables::edgesPositions(this->edges);
+    long sizes[2] = {Symmetries::tables().cornersEntries(),
+                     positions << this->edges};
+    edgesFile(this->edges, files[1]);
 
-    //With table 2, first cubie is 8-th cubie 
-    int offset = (table-1)*8;     
-    int i;
-    int k = 0;
-    for (i = offset; i < 8 + offset; i++) {
-        if (i % 2 != 0) {
-            int p = cube.getPosition(i);
-            int elem = p / 2;
-            if (p > 16) {
-                elem = p - 8;
-            }
-            positions[k] = elem;
-            k++;
-        }
+    printf("----Initializing %s\n", names[t]);
+    PdbTable *table = this->table(t);
+    table->allocate(sizes[t], bits);
+
+    Rubik goalcube;
+    goalcube.transformToGoal();
+    this->reach(t, this->entry(t, this->index(t, goalcube)), 0);
+
+    int depth = 0;
+    long found = 1;
+    while (found > 0) {
+        //Tables that keep costs mod 3 also hold older layers with the same
+        //value. Expanding them again is harmless: it finds nothing new
+        int value = depth;
+        if (table->isMod3())
+            value = depth % 3;
+
+        atomic<long> next(0);
+        atomic<long> count(0);
+        vector<thread> workers;
+        int k;
+        for (k = 0; k < threads; k++)
+            workers.push_back(thread(&Rubikpd::expandLayer, this, t, value,
+                                     depth + 1, &next, &count));
+        for (k = 0; k < threads; k++)
+            workers[k].join();
+
+        found = count;
+        depth++;
+        printf("        %s depth %d: %ld states\n", names[t], depth, found);
     }
 
-    //Same goes for edges in middle face
-    int firstmiddle = 16 + (offset / 4); 
-    k =  4;
-    for (i = firstmiddle; i <= firstmiddle + 1; i++) {
-        int p = cube.getPosition(i);
-        int elem = p / 2;
-        if (p > 16) {
-            elem = p - 8;
+    //Printing to binary file
+    *written = table->writeFile(files[t], kinds[t], bits);
+};
+
+
+/**
+  * Expands chunks of a table until the whole table has been scanned.
+  * Every entry holding 'value' is expanded, and its successors that
+  * haven't been reached get 'cost'
+  * @param 't'     : 0 for corners, 1 for edges1
+  * @param 'value' : value of the entries to expand
+  * @param 'cost'  : cost of their successors
+  * @param 'next'  : first entry of the next chunk nobody has taken
+  * @param 'found' : counter of entries reached
+  */
+
+void Rubikpd::expandLayer(int t, int value, int cost, atomic<long> *next,
+                          atomic<long> *found) {
+    PdbTable *table = this->table(t);
+    int unreached = table->unreached();
+    long size = table->size();
+    long chunk = 65536;
+    long reached = 0;
+
+    while (true) {
+        long first = next->fetch_add(chunk);
+        if (first >= size)
+            break;
+        long last = first + chunk;
+        if (last > size)
+            last = size;
+
+        long i;
+        for (i = first; i < last; i++) {
+            if (table->get(i) != value)
+                continue;
+
+            long children[18];
+            this->successors(t, this->state(t, i), children);
+
+            int k;
+            for (k = 0; k < 18; k++) {
+                long child = this->entry(t, children[k]);
+                if (table->get(child) == unreached)
+                    reached += this->reach(t, child, cost);
+            }
         }
-        positions[k] = elem;
-        k++;
     }
 
-    int set[12], inverse[12];
-    this->auxiliaryRankEdgesP(positions, set, inverse);
+    *found += reached;
+};
+
 
-    return (rankAux(6, 12, set, inverse));  //rank a sequence of integers
+/**
+  * Gets the indexes of the 18 successors of an entry of a table, in the
+  * same order as Rubik::getSucc, without building any Rubik's cube
+  * @param 't'        : 0 for corners, or the edge lookup (see setLookups)
+  * @param 'i'        : index of the entry
+  * @param 'children' : array where the 18 indexes are stored
+  */
+
+void Rubikpd::successors(int t, long i, long *children) const {
+    const MoveTables &moves = MoveTables::tables();
+    if (t == 0)
+        moves.successorsCorners(i, children);
+    else
+        moves.successorsEdges(this->edges, i, children);
 };
 
 
 /**
-  * Set the three elementes necessary to do k-permutations of an n-set
-  * @param 'positions' :   K elements to be permuted
-  * @param 'set'       :   Array of integers to be ranked
-  * @param 'inverse'   :   Invers of set
+  * Initializes pattern database of corner permutations 
+  * @param 'bits' : bits per entry in memory and in cornersym.pdb (8, 4 or 2)
+  * @return True if cornersym.pdb could be written. False in any other case
   */
 
-void Rubikpd::auxiliaryRankEdgesP(int *positions, int *set, int *inverse) {
-    int i, k;
-    //Get subset
-    int appear[12];
+bool Rubikpd::initializeCorners(int bits) {
+    printf("----Initializing corners\n");
+    //initialize every cost in the largest value (3, 15 or 255)
+    this->corners.allocate(Symmetries::tables().cornersEntries(), bits);
+    int unreached = this->corners.unreached();
+
+    Rubik goalcube;
+    goalcube.transformToGoal();
+    int goal = this->entry(0, this->rankC(goalcube));
+    this->reach(0, goal, 0);
 
-    for (i = 0; i < 12; i++)
-        appear[i] = 0;
+    list<int> open;   //open queue of entries
+    open.push_back(goal);
+    
+    while (!open.empty()) {
+        int parent = open.front();        //top
+        open.pop_front();                 //pop 
 
-    for (i = 0; i < 6; i++)
-        appear[positions[i]] = 1;
+        long children[18];               //Successors
+        this->successors(0, this->state(0, parent), children);
 
-    //Positions elements are the last K-elements 
-    for (i = 6; i < 12; i++)    
-        set[i] = positions[i % 6];
+        int k;
+        for (k = 0; k < 18; k++) {
+            int child = this->entry(0, children[k]);
 
-    k = 0;
-    for (i = 0; i < 12; i++) {
-        if (appear[i] == 0) {
-            set[k] = i;
-            k++;
+            //Already closed or in open queue
+            if (this->corners.get(child) != unreached)  
+                continue;
+            
+            //Entries of the same state are reached together
+            this->reach(0, child, this->corners.get(parent) + 1);
+            open.push_back(child);
         }
     }
 
-    //Calculate inverse 
-    for (i = 0; i < 12; i++)
-        inverse[set[i]] = i;
+    //Printing to binary file cornersym.pdb
+    return this->corners.writeFile("cornersym.pdb", PDB_CORNERS_SYM, bits);
 };
 
 
 /**
-  * Ranks a Rubik's cube partly by taking only six edges orientations 
-  *
-  * @section Description
-  * Edge cubies have only two possible directions in a certain position
-  * @param 'cube' : Rubik's cube configuration
-  * @return Permutation of orientations (value between 0 and 63)
+  * Initializes pattern database of edge permutations (edges1)
+  * @param 'bits'  : bits per entry in memory and in the file of edges1
+  *                  (8, 4 or 2)
+  * @return True if the file could be written. False in any other case
   */
 
-int Rubikpd::rankEdgesO(int table, Rubik cube) {
-    int offset = (table-1)*8;
-    int rank = 0;
+bool Rubikpd::initializeEdges(int bits) {
+    printf("----Initializing edges1 (%d edges)\n", this->edges);
 
-    //Left or Right face
-    int i;
-    for (i = 1; i <= 7; i = i + 2) {
-        if (cube.isMaxOriented(i + offset)) 
-            rank = rank + 1;
-        rank = rank*2;
-    }
+    //Default values (3, 15 or 255)
+    long size = (long) MoveTables::edgesPositions(this->edges) << this->edges;
+    this->edges1.allocate(size, bits);
+    int unreached = this->edges1.unreached();
 
-    //Middle face
-    for (i = 0; i < 2; i++) {
-        if (cube.isMaxOriented(16 + i + (offset / 4)))
-            rank = rank + 1;
-        rank = rank * 2;
-    }
+    Rubik goalcube;
+    goalcube.transformToGoal();
+    long goal = this->rankE(1, goalcube);
 
-    rank = rank / 2;
+    this->edges1.set(goal, 0);
 
-    return rank;
+    list<long> open;     //open queue for edges1
+    open.push_back(goal);
+
+    while (!open.empty()) {
+        long parent = open.front();  //top
+        open.pop_front();            //pop
+
+        long children[18];           //successors
+        this->successors(1, parent, children);
+
+        int k;
+        for (k = 0; k < 18; k++) {
+            long child = children[k];
+
+            //Already close or in open queue
+            if (this->edges1.get(child) != unreached)
+                continue;
+            
+            this->edges1.set(child, this->edges1.get(parent) + 1);
+
+            open.push_back(child);
+        }
+    }
+
+    //Printing to binary file edges1.pdb, edges1_7.pdb or edges1_8.pdb
+    char name[16];
+    edgesFile(this->edges, name);
+    return this->edges1.writeFile(name, PDB_EDGES1, bits);
 };
 
 
 /**
-  * Unranks a permutation of edge cubies
-  * @param 'p' : integer value between 0 and 42.577.919
-  * @return Rubik's cube configuration 
+  * Ranks a Rubik's cube partly by taking only corners
+  * @param 'cube' : Rubik's cube configuration
+  * @return Ranked permutation (value between 0 and 264.539.519)
   */
 
-Rubik Rubikpd::unrankE(int table, int p) {
-    int t = 64;   //2^6
-    Rubik cube;
-    cube.clean();
-
-    Rubik positions = this->unrankEdgesP(table, p / t);
-    Rubik all = this->unrankEdgesAux(table, p % t, positions);
+int Rubikpd::rankC(Rubik cube) const {
+    int x = this->rankCornersP(cube);     //Permutation of positions
+    int y = this->rankCornersO(cube);     //Permutation of orientations
 
-    return all;
+    return x*(pow(3,8)) + y;
 };
 
 
 /**
-  * Gets a Rubik's cube configuration without orientations (only position) 
-  * It uses unrankAux from utils.hh to unrank an intenger into
-  * a sequence of integers
-  * from an integer value between 0 and 665.279 (ranked permutation
-  * of positions)
-  * @param 'x' : permutation of corner positions represented as an int
-  * @return Rubik's cube configuration
+  * Ranks a Rubik's cube partly by taking only corner positions 
+  * It uses rankPermutation from utils.hh to rank a permutation of 
+  * integers into an integer
+  * @param 'cube' : Rubik's cube configuration
+  * @return Permutation of the corner positions (value between 0 and 40319)
   */
 
-Rubik Rubikpd::unrankEdgesP(int table, int x) {
-    Rubik cube;
-    cube.clean();
+int Rubikpd::rankCornersP(Rubik cube) const {
+    int positions[8];
+    int k = 0;
     
-    int offset = (table-1)*8;
-    int identity[12] = {0,1,2,3,4,5,6,7,8,9,10,11};
+    //Transforms a Rubik's cube into a permutation of corners
+    int i;
+    for (i = 0; i < 16; i++) {
+        if (i % 2 == 0) {
+            positions[k] = (cube.getPosition(i)) / 2;
+            k++;
+        }
+    }
 
-    unrankAux(6, 12, x, identity);
+    return rankPermutation(8, 8, positions);  //rank a sequence of integers
+};
 
-    //Transform sequence into a Rubik's cube configuration
-    int k = 0;
+
+/**
+  * Ranks a Rubik's cube partly by taking only corner orientations 
+  *
+  * @section Description
+  *
+  * There are 3 orientations X,Y,Z: 100, 010, 001
+  * And they are gonna be represent as 0,1, or 2
+  * That's why % 4 is used!
+  *
+  * @param 'cube' : Rubik's cube configuration
+  * @return Orientation permutations (value between 0 and 6560)
+  */
+
+int Rubikpd::rankCornersO(Rubik cube) const {
+    int rank = 0;
     int i;
-    for (i = 6; i < 10; i++) {
-        unsigned char cubie = identity[i]*2 + 1;
-        if (identity[i] >= 8) {
-            cubie = identity[i] + 8;  
+    
+    for (i = 0; i < 16; i++) {
+        if (i % 2 == 0) {
+            //represent orientations as 0,1, or 2
+            int orientation = cube.getOrientation(i) % 4;
+            rank = (rank*3) + orientation;
         }
-        cubie = cubie << 3;
-        cube.setCubie(k*2 + 1 + offset, cubie);
-        k++;
     }
-    
-    int middle = 16 + (offset / 4);
-    for (i = 10; i < 12; i++) {
-        unsigned char cubie = identity[i]*2 + 1;
-        if (identity[i] >= 8)
-            cubie = identity[i] + 8;
 
-        cubie = cubie << 3;
-        cube.setCubie(middle, cubie);
-        middle++;
-    } 
+    return rank;
+};
+
 
-    return cube;
+/**
+  * Ranks a Rubik's cube partly by taking only the edges of a pattern
+  * @param 'table' : Has what table is going to be used
+  * @param 'cube'  : Rubik's cube configuration
+  * @return Ranked permutation (value between 0 and (12!/(12-k)!)x(2^k) - 1
+  *         for a pattern of k edges)
+  */
+
+long Rubikpd::rankE(int table, Rubik cube) const {
+    long x = this->rankEdgesP(table, cube);     //Permutation of positions
+    int y = this->rankEdgesO(table, cube);      //Permutation of orientations
+
+    return (x << this->edges) + y;
 };
 
 
 /**
-  * Gets a Rubik's cube configuration mergin positions and orientations
-  * This is an auxiliary method for unrankE
-  * @param 'x' : permutation of corner orientations represented as an integer
-  * @param 'positions' : Rubik's cube configuration with its positions
-  * @return Rubik's cube configuration
+  * Ranks a Rubik's cube partly by taking only the positions of the edges
+  * of a pattern (see Symmetries::pattern)
+  * It uses rankPermutation from utils.hh to rank a k-permutation of 
+  * integers into an integer
+  *
+  * @param 'table' : Lookup we are ranking (1 for edges1, 2 for edges2, ...)
+  * @param 'cube'  : Rubik's cube configuration
+  * @return Permutation of positions (value between 0 and 12!/(12-k)! - 1)
   */
 
-Rubik Rubikpd::unrankEdgesAux(int table, int x, Rubik positions) {
-    Rubik cube;
-    cube = positions.clone();
-    int i;
-    int y = x;
-    int offset = (table-1)*8;
-    int k = 1 + offset;
-    for (i = 5; i > 1; i--) {
-        //calculate orientation of di with pure magic
-        int power = pow(2, i);
-        int di = y / power;
-        y = y - (di*power);
-        
-        unsigned char cubie;
-
-        if (di == 1) {
-            cube.setMaxOrientation(k);
-        }
-        else {
-            cube.setMinOrientation(k);
-        }
+int Rubikpd::rankEdgesP(int table, Rubik cube) const {
+    const int *pattern = Symmetries::tables().pattern(this->symmetries[table]);
+    int positions[EDGES_MAX];
 
-        k = k + 2;
+    //Left and right faces are numbered 0..7 and middle face 8..11
+    int k;
+    for (k = 0; k < this->edges; k++) {
+        int p = cube.getPosition(pattern[k]);
+        int elem = p / 2;
+        if (p > 16) {
+            elem = p - 8;
+        }
+        positions[k] = elem;
     }
 
-    //Last two cubies this->middle[x], this->middle[x+1]
-    k = 16 + (offset / 4); 
-    int di = y / 2;
-    y = y - (di*2);
+    return MoveTables::rankEdgesP(this->edges, positions);
+};
 
-    if (di == 1) {
-        cube.setMaxOrientation(k);
-    }
-    else {
-        cube.setMinOrientation(k);
-    }
 
-    k++;
+/**
+  * Ranks a Rubik's cube partly by taking only the orientations of the
+  * edges of a pattern
+  *
+  * @section Description
+  * Edge cubies have only two possible directions in a certain position
+  * @param 'table' : Lookup we are ranking (1 for edges1, 2 for edges2, ...)
+  * @param 'cube'  : Rubik's cube configuration
+  * @return Permutation of orientations (value between 0 and 2^k - 1)
+  */
+
+int Rubikpd::rankEdgesO(int table, Rubik cube) const {
+    const int *pattern = Symmetries::tables().pattern(this->symmetries[table]);
+    int rank = 0;
 
-    di = y;
-    if (di == 1) {
-        cube.setMaxOrientation(k);
-    }
-    else {
-        cube.setMinOrientation(k);
+    //First edge is the most significant bit
+    int k;
+    for (k = 0; k < this->edges; k++) {
+        rank = rank*2;
+        if (cube.isMaxOriented(pattern[k]))
+            rank = rank + 1;
     }
-    
-    return cube;
+
+    return rank;
 };
+
@@ -12,7 +12,73 @@
 #define RUBIKPD_HH
 
 #include <stdio.h>
+#include <climits>
+#include <memory>
+#include <atomic>
 #include "rubik.hh"
+#include "pdbtable.hh"
+
+/*
+ * Largest number of lookups made for a state: corners, and edges1 through
+ * up to 16 symmetries (edges1 itself, edges2, and the other sets of edges
+ * turned to edges1, see setLookups)
+ */
+#define PDB_LOOKUPS 17
+
+/*
+ * No pattern is farther from the goal than this (no cube is more than 20
+ * moves away), so a longer walk down a table that keeps costs mod 3 means
+ * the table is corrupt
+ */
+#define PATTERN_DEPTH_MAX 20
+
+/*
+ * Version of the layout of the shared memory segments of Rubikpd::publish
+ */
+#define SHM_VERSION 3
+
+/*
+ * Alignment of the tables in a shared memory segment, so that each one
+ * can be backed by huge pages
+ */
+#define SHM_ALIGN (2L << 20)
+
+/*
+ * Seconds a process waits for a segment that another process is
+ * publishing
+ */
+#define SHM_WAIT 60
+
+/*
+ * Table of a shared memory segment: where its .pdb image is, and the file
+ * it was loaded from when the segment was published
+ */
+typedef struct ShmTable ShmTable;
+
+struct ShmTable {
+    unsigned long long offset;     //Start of the image in the segment
+    unsigned long long length;     //Length of the image
+    char source[PATH_MAX];         //Absolute path of the file the table
+                                   //was loaded from
+    unsigned long long size;       //Size of the file
+    long long modified;            //Modification time of the file (ns)
+    unsigned long long inode;      //Inode of the file
+};
+
+/*
+ * Header of a shared memory segment. The .pdb images of corners and edges1
+ * follow, each one starting at a multiple of SHM_ALIGN
+ */
+typedef struct ShmHeader ShmHeader;
+
+struct ShmHeader {
+    char magic[8];                 //"RUBIKSHM"
+    unsigned int version;          //SHM_VERSION
+    unsigned int ready;            //Set once the tables are written
+    unsigned int edges;            //Number of edges of edges1
+    int publisher;                 //Pid of the process that publishes it
+    ShmTable tables[2];            //corners and edges1
+};
 
 /*
  * Rubikpd class
@@ -21,56 +87,101 @@ class Rubikpd {
     private:
         /*
          * Cost of every Rubik's cube configuration taking only corners cubies
-         * There are 8!x3^8 = 264.539.520 possible configurations
+         * There are 8!x3^8 = 264.539.520 possible configurations, but only
+         * one configuration of every class of configurations related by a
+         * symmetry that keeps the top-bottom axis is stored (see Symmetries):
+         * 2768x3^8 = 18.160.848 entries
+         * No cost is above 11, and no edge cost is above 10, so the tables
+         * can keep two entries per byte (about 30 MB for the two)
          */
-        unsigned char corners[264539520];   
+        PdbTable corners;
 
         /*
          * Cost of every Rubik's cube configuration taking only edges cubies
          * placed in the left face, and the first two cubies of the middle face
          * (middle[0], middle[1])
          * There are (12!/6!)x(2^6) = 42.577.920 possible configurations
+         *
+         * Larger patterns add middle[2] (seven edges) and middle[3] (eight
+         * edges): (12!/5!)x(2^7) = 510.935.040 and (12!/4!)x(2^8) =
+         * 5.109.350.400 configurations, about 2.5 GB with two entries per byte
+         * or 1.3 GB with four
+         *
+         * edges2 (edges cubies placed in the right face, and the last two
+         * cubies of the middle face) is the same pattern turned half around
+         * the top-bottom axis, so its costs are looked up in edges1, and
+         * so are the costs of other sets of edges turned by other symmetries
          */
-        unsigned char edges1[42577920];
-
-        /*
-         * Cost of every Rubik's cube configuration taking only edges cubies
-         * placed in the right face, and the last two cubies of the middle face
-         * (middle[2], middle[3])
-         * There are (12!/6!)x(2^6) = 42.577.920 possible configurations
-         */
-        unsigned char edges2[42577920];
+        PdbTable edges1;
+        int edges;     //Number of edges of edges1 and edges2 (6, 7 or 8)
+        int lookups;   //Number of edge lookups made for every state
+        int wanted;    //Number of edge lookups asked for
+        int symmetries[PDB_LOOKUPS];   //Symmetry of every edge lookup
+        ShmTable sources[2];   //Files the tables were loaded from, stamped
+                               //when they were (see publish)
      
     public:
-        int heuristic(Rubik);
-        void initializeAll();
-        void initializeAllWithFiles();
+        Rubikpd();
+        void setLookups(int);
+        int getLookups() const;
+        int getEdges() const;
+        int heuristic(Rubik) const;
+        int dual(Rubik) const;
+        int dual(const long *) const;
+        int lookupDual(const long *) const;
+        bool hasDual() const;
+        int values(Rubik,int *) const;
+        int values(Rubik,const int *,int *) const;
+        int values(const long *,int *) const;
+        int values(const long *,const int *,int *) const;
+        int lookup(const long *,const int *,int *) const;
+        void entries(const long *,long *) const;
+        void indexes(Rubik,long *) const;
+        void moveIndexes(const long *,int,long *) const;
+        bool initializeAll(int,bool,int,int);
+        bool initializeAllWithFiles(int);
+        bool publish(const char *);
+        bool attach(const char *);
+        void prefetch() const;
+        void prefetch(const long *) const;
     private:
-        void initializeCorners();
-        void initializeEdges(int);
-        void initializeCornersWithFile();
-        void initializeEdgesWithFile(int);
+        Rubikpd(const Rubikpd &);              //Tables are never copied
+        Rubikpd &operator=(const Rubikpd &);
+        int descend(int,long) const;
+        long index(int,Rubik) const;
+        const PdbTable *table(int) const;
+        PdbTable *table(int);
+        void chooseLookups();
+        bool mapSegment(int,const char *,const ShmHeader &);
+        void reportPages() const;
+        long entry(int,long) const;
+        long state(int,long) const;
+        int reach(int,long,int);
+
+        bool initializeCorners(int);
+        bool initializeEdges(int);
+        void initializeLayered(int,int,int,bool *);
+        void expandLayer(int,int,int,std::atomic<long> *,std::atomic<long> *);
+        void successors(int,long,long *) const;
+        bool initializeCornersWithFile(int);
+        bool initializeEdgesWithFile(int);
+        bool reduceCorners();
 
         //Methods to rank permutation of corners cubies
-        int rankC(Rubik);      
-        int rankCornersP(Rubik);   //Auxiliary method to rankC
-        int rankCornersO(Rubik);     //Auxiliary method to rankC
-
-        //Methods to unrank permutation of corners cubies
-        Rubik unrankC(int);
-        Rubik unrankCornersP(int);     //Corner Positions 
-        Rubik unrankCornersO(int);     //Corner Orientations
-
-        //Methods to rank permutation of edges cubies in edges1
-        int rankE(int,Rubik);
-        int rankEdgesP(int,Rubik);
-        void auxiliaryRankEdgesP(int *,int *,int *);
-        int rankEdgesO(int,Rubik);
-
-        //Methods to unrank permutation of edges cubies in edges1
-        Rubik unrankE(int,int);
-        Rubik unrankEdgesP(int,int);          //Edge Positions 
-        Rubik unrankEdgesAux(int,int,Rubik);  //Auxiliary method
+        int rankC(Rubik) const;      
+        int rankCornersP(Rubik) const;   //Auxiliary method to rankC
+        int rankCornersO(Rubik) const;     //Auxiliary method to rankC
+
+        //Methods to rank permutation of edges cubies in edges1 or edges2
+        long rankE(int,Rubik) const;
+        int rankEdgesP(int,Rubik) const;
+        int rankEdgesO(int,Rubik) const;
 };
 
+/*
+ * Shared handle to pattern databases that are no longer modified. The
+ * tables are released when the last handle goes away
+ */
+typedef std::shared_ptr<const Rubikpd> PdbHandle;
+
 #endif
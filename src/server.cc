@@ -0,0 +1,382 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Solver daemon: the pattern databases are loaded once, and cubes sent
+  * over a Unix socket are solved by a pool of workers
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <climits>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <string>
+#include "server.hh"
+#include "batch.hh"
+
+using namespace std;
+
+/*
+ * Cube waiting for a worker or being solved. It lives in the thread of
+ * its connection until it is answered
+ */
+typedef struct Request Request;
+
+struct Request {
+    Rubik cube;
+    bool timed;                             //Whether it has a deadline
+    chrono::steady_clock::time_point start;
+    chrono::steady_clock::time_point deadline;
+    atomic<bool> stop;                      //Set at the deadline
+    bool done;
+    string response;
+};
+
+/*
+ * State shared by the connections, the workers and the deadline watcher
+ */
+typedef struct Server Server;
+
+struct Server {
+    const Solver *solver;
+    int workers;                   //Requests solved at once
+    int capacity;                  //Most requests waiting at once
+    mutex lock;                    //Guards the rest
+    condition_variable work;       //A request was queued
+    condition_variable answered;   //A request was answered
+    condition_variable deadlines;  //A request with a deadline was queued
+    condition_variable closed;     //A connection was closed
+    deque<Request *> waiting;
+    list<Request *> running;
+    int connections;               //Connections being served
+    long solved;
+    long busy;
+    long timeouts;
+};
+
+
+/**
+  * Worker. Solves the requests in the order they came
+  * @param 'server' : daemon
+  */
+
+static void solveRequests(Server *server) {
+    unique_lock<mutex> lock(server->lock);
+    while (true) {
+        while (server->waiting.empty())
+            server->work.wait(lock);
+
+        Request *request = server->waiting.front();
+        server->waiting.pop_front();
+        if (request->timed &&
+            (chrono::steady_clock::now() >= request->deadline))
+            request->stop = true;
+        server->running.push_back(request);
+        lock.unlock();
+
+        Solution sol;
+        sol.cost = INT_MAX;
+        sol.nodes = 0;
+        if (!request->stop)
+            sol = server->solver->solve(request->cube, &request->stop);
+        chrono::duration<double, milli> time =
+            chrono::steady_clock::now() - request->start;
+
+        char fields[64];
+        if (sol.cost == INT_MAX) {
+            sprintf(fields, "%ld\t%.1f", sol.nodes, time.count());
+            request->response = string("TIMEOUT\t") + fields;
+        }
+        else {
+            sprintf(fields, "%d\t%ld\t%.1f\t", sol.cost, sol.nodes,
+                    time.count());
+            request->response = string("OK\t") + fields +
+                                formatMoves(sol.path);
+        }
+
+        lock.lock();
+        server->running.remove(request);
+        if (sol.cost == INT_MAX)
+            server->timeouts++;
+        else
+            server->solved++;
+        request->done = true;
+        server->answered.notify_all();
+    }
+};
+
+
+/**
+  * Answers a request that reached its deadline before a worker took it.
+  * The lock of the server must be held
+  * @param 'server'  : daemon
+  * @param 'request' : request, already taken out of the queue
+  */
+
+static void expireRequest(Server *server, Request *request) {
+    chrono::duration<double, milli> time =
+        chrono::steady_clock::now() - request->start;
+
+    char fields[64];
+    sprintf(fields, "0\t%.1f", time.count());
+    request->response = string("TIMEOUT\t") + fields;
+    server->timeouts++;
+    request->done = true;
+    server->answered.notify_all();
+};
+
+
+/**
+  * Answers the waiting requests and stops the searches that reach their
+  * deadline. It sleeps until the earliest deadline, or until a request
+  * with a deadline is queued
+  * @param 'server' : daemon
+  */
+
+static void watchDeadlines(Server *server) {
+    typedef chrono::steady_clock::time_point Time;
+    unique_lock<mutex> lock(server->lock);
+    while (true) {
+        Time now = chrono::steady_clock::now();
+        Time next = Time::max();
+
+        deque<Request *>::iterator w = server->waiting.begin();
+        while (w != server->waiting.end()) {
+            Request *request = *w;
+            if (request->timed && (now >= request->deadline)) {
+                w = server->waiting.erase(w);
+                expireRequest(server, request);
+                continue;
+            }
+            if (request->timed)
+                next = min(next, request->deadline);
+            ++w;
+        }
+
+        list<Request *>::iterator r;
+        for (r = server->running.begin(); r != server->running.end(); ++r) {
+            if (!(*r)->timed || (*r)->stop)
+                continue;
+            if (now >= (*r)->deadline)
+                (*r)->stop = true;
+            else
+                next = min(next, (*r)->deadline);
+        }
+
+        if (next == Time::max())
+            server->deadlines.wait(lock);
+        else
+            server->deadlines.wait_until(lock, next);
+    }
+};
+
+
+/**
+  * Answers a request line
+  * @param 'server' : daemon
+  * @param 'line'   : request (see server.hh)
+  * @return Response, without the end of line
+  */
+
+static string answer(Server *server, const string &line) {
+    if (line == "PING")
+        return "PONG";
+
+    if (line == "STATS") {
+        lock_guard<mutex> guard(server->lock);
+        char fields[128];
+        sprintf(fields, "STATS\t%d\t%d\t%ld\t%ld\t%ld",
+                (int) server->waiting.size(), (int) server->running.size(),
+                server->solved, server->busy, server->timeouts);
+        return fields;
+    }
+
+    if (line.compare(0, 6, "SOLVE ") != 0)
+        return "ERROR\tunknown request";
+
+    Request request;
+    request.start = chrono::steady_clock::now();
+    request.stop = false;
+    request.done = false;
+
+    const char *text = line.c_str() + 6;
+    char *end;
+    long milliseconds = strtol(text, &end, 10);
+    if ((end == text) || (milliseconds < 0))
+        return "ERROR\tSOLVE takes the milliseconds before the cube";
+    request.timed = milliseconds > 0;
+    request.deadline = request.start + chrono::milliseconds(milliseconds);
+
+    string error;
+    if (!parseCube(end, &request.cube, &error))
+        return "ERROR\t" + error;
+
+    //Workers move requests from waiting to running under the same lock
+    unique_lock<mutex> lock(server->lock);
+    int pending = server->waiting.size() + server->running.size();
+    if (pending >= server->workers + server->capacity) {
+        server->busy++;
+        return "BUSY";
+    }
+    server->waiting.push_back(&request);
+    server->work.notify_one();
+    if (request.timed)
+        server->deadlines.notify_one();
+    while (!request.done)
+        server->answered.wait(lock);
+
+    return request.response;
+};
+
+
+/**
+  * Writes a whole response
+  * @param 'fd'       : socket
+  * @param 'response' : response
+  * @return False if the client is gone
+  */
+
+static bool sendAll(int fd, const string &response) {
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(fd, response.data() + sent, response.size() - sent,
+                         MSG_NOSIGNAL);
+        if ((n < 0) && (errno == EINTR))
+            continue;
+        if (n <= 0)
+            return false;
+        sent += n;
+    }
+
+    return true;
+};
+
+
+/**
+  * Reads the requests of a connection and writes their responses until
+  * the client closes it
+  * @param 'server' : daemon
+  * @param 'fd'     : socket of the connection
+  */
+
+static void serveConnection(Server *server, int fd) {
+    string pending;
+    char buffer[REQUEST_MAX];
+    while (true) {
+        size_t end = pending.find('\n');
+        if (end == string::npos) {
+            if (pending.size() > REQUEST_MAX) {
+                sendAll(fd, "ERROR\trequest too long\n");
+                break;
+            }
+
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if ((n < 0) && (errno == EINTR))
+                continue;
+            if (n <= 0)
+                break;
+            pending.append(buffer, n);
+            continue;
+        }
+
+        string line = pending.substr(0, end);
+        pending.erase(0, end + 1);
+        if (!line.empty() && (line[line.size() - 1] == '\r'))
+            line.erase(line.size() - 1);
+
+        if (!sendAll(fd, answer(server, line) + "\n"))
+            break;
+    }
+
+    close(fd);
+    lock_guard<mutex> guard(server->lock);
+    server->connections--;
+    server->closed.notify_one();
+};
+
+
+/**
+  * Runs the daemon until the process is killed
+  * @param 'solver'   : solver shared by the workers
+  * @param 'path'     : path of the socket. A socket left there by an
+  *                     earlier daemon is replaced
+  * @param 'workers'  : number of cubes solved at once
+  * @param 'capacity' : most requests waiting for a worker
+  * @return 1 if the socket can't be opened (it doesn't return otherwise)
+  */
+
+int serveSolver(const Solver &solver, const char *path, int workers,
+                int capacity) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s is too long for a socket\n", path);
+        return 1;
+    }
+    strcpy(address.sun_path, path);
+
+    struct stat info;
+    if ((stat(path, &info) == 0) && S_ISSOCK(info.st_mode))
+        unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((fd < 0) ||
+        (bind(fd, (struct sockaddr *) &address, sizeof(address)) < 0) ||
+        (listen(fd, SOMAXCONN) < 0)) {
+        fprintf(stderr, "Can't listen on %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    solver.warmUp();
+
+    Server server;
+    server.solver = &solver;
+    server.workers = workers;
+    server.capacity = capacity;
+    server.solved = 0;
+    server.busy = 0;
+    server.timeouts = 0;
+    server.connections = 0;
+
+    int i;
+    for (i = 0; i < workers; i++)
+        thread(solveRequests, &server).detach();
+    thread(watchDeadlines, &server).detach();
+
+    fprintf(stderr, "Listening on %s\n", path);
+    while (true) {
+        //Clients beyond the limit wait in the backlog of the socket
+        unique_lock<mutex> lock(server.lock);
+        while (server.connections >= CONNECTIONS_MAX)
+            server.closed.wait(lock);
+        lock.unlock();
+
+        int client = accept(fd, NULL, NULL);
+        if (client < 0) {
+            //Out of descriptors or an aborted connection: try again
+            if (errno != EINTR)
+                this_thread::sleep_for(chrono::milliseconds(10));
+            continue;
+        }
+
+        lock.lock();
+        server.connections++;
+        lock.unlock();
+        thread(serveConnection, &server, client).detach();
+    }
+};
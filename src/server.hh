@@ -0,0 +1,53 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Solver daemon header
+  */
+
+#ifndef SERVER_HH
+#define SERVER_HH
+
+#include "idastar.hh"
+
+/*
+ * Longest request line accepted
+ */
+#define REQUEST_MAX 4096
+
+/*
+ * Most connections served at once, each by a thread of its own. Further
+ * clients wait to be accepted until one of them is closed
+ */
+#define CONNECTIONS_MAX 64
+
+/*
+ * The daemon listens on a Unix socket. A client writes a request line and
+ * reads the response line before writing the next request, and the fields
+ * of a response are separated by tabs:
+ *
+ *   SOLVE <milliseconds> <cube>    Cube written as in batch.hh. The search
+ *                                  is given up after that many milliseconds
+ *                                  from the request (0: never)
+ *       OK <length> <nodes> <milliseconds> <moves>
+ *       TIMEOUT <nodes> <milliseconds>
+ *       BUSY                       Too many requests waiting, nothing done
+ *       ERROR <reason>
+ *   STATS
+ *       STATS <waiting> <running> <solved> <busy> <timeouts>
+ *   PING
+ *       PONG
+ *
+ * Requests of every connection go to a queue shared by the workers, and a
+ * request that finds every worker busy and the queue full is answered
+ * BUSY at once. A request
+ * whose deadline passes while it waits is answered TIMEOUT without
+ * waiting for a worker
+ */
+
+extern int serveSolver(const Solver &,const char *,int,int);
+
+#endif
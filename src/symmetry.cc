@@ -0,0 +1,509 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Symmetries class
+  */
+
+#include <stddef.h>
+#include "symmetry.hh"
+#include "rubik.hh"
+#include "utils.hh"
+
+/*
+ * Coordinates (x, y, z) of the center of every position. X goes from the
+ * left face to the right face, Y from the back face to the front face and
+ * Z from the bottom face to the top face
+ */
+static const int coordinates[20][3] = {
+    {-1,-1,-1}, {-1, 0,-1}, {-1, 1,-1}, {-1, 1, 0},    //Left face
+    {-1, 1, 1}, {-1, 0, 1}, {-1,-1, 1}, {-1,-1, 0},
+    { 1, 1,-1}, { 1, 0,-1}, { 1,-1,-1}, { 1,-1, 0},    //Right face
+    { 1,-1, 1}, { 1, 0, 1}, { 1, 1, 1}, { 1, 1, 0},
+    { 0, 1,-1}, { 0, 1, 1}, { 0,-1, 1}, { 0,-1,-1},    //Middle face
+};
+
+
+/**
+  * Returns the symmetry tables, building them the first time
+  * @return Symmetry tables shared by every pattern database
+  */
+
+const Symmetries &Symmetries::tables() {
+    static Symmetries tables;    //Built once, even with several threads
+    return tables;
+};
+
+
+/**
+  * Builds every table
+  */
+
+Symmetries::Symmetries() {
+    this->initializeSlots();
+    this->initializeCubies();
+    this->initializeCorners();
+    this->initializeEdges();
+};
+
+
+/**
+  * Frees the tables
+  */
+
+Symmetries::~Symmetries() {
+    delete[] this->cornersClass;
+    delete[] this->cornersSym;
+    delete[] this->cornersRep;
+    delete[] this->cornersStabilizer;
+    int s;
+    for (s = 0; s < SYMMETRIES; s++)
+        delete[] this->edgesP[s];
+};
+
+
+/**
+  * Applies a symmetry to a Rubik's cube
+  * @param 's'    : symmetry (between 0 and 15)
+  * @param 'cube' : Rubik's cube configuration
+  * @return The configuration seen through the symmetry
+  */
+
+Rubik Symmetries::conjugate(int s, Rubik cube) const {
+    Rubik image;
+    image.clean();
+
+    int i;
+    for (i = 0; i < 20; i++) {
+        unsigned char cubie = this->cubies[s][i][cube.getCubie(i)];
+        image.setCubie(this->slots[s][i], cubie);
+    }
+
+    return image;
+};
+
+
+/**
+  * Gets the entry of the corners table that keeps a state
+  * @param 'i' : index of the state (corner positions * 3^8 + orientations)
+  * @return Entry of the class of the state (class * 3^8 + orientations)
+  */
+
+long Symmetries::reduceCorners(long i) const {
+    int p = i / CORNERS_O;
+    int o = i % CORNERS_O;
+    int s = this->cornersSym[p];
+
+    return (long) this->cornersClass[p]*CORNERS_O + this->cornersO[s][o];
+};
+
+
+/**
+  * Gets the state of an entry of the corners table: the representative of
+  * the class with the orientations of the entry
+  * @param 'entry' : entry of the corners table
+  * @return Index of the state (corner positions * 3^8 + orientations)
+  */
+
+long Symmetries::cornersState(long entry) const {
+    int c = entry / CORNERS_O;
+    int o = entry % CORNERS_O;
+
+    return (long) this->cornersRep[c]*CORNERS_O + o;
+};
+
+
+/**
+  * Gets the other entries of the corners table that keep the same state.
+  * When a symmetry keeps the representative of a class, it takes the
+  * orientations to other orientations of the same state
+  * @param 'entry' : entry of the corners table
+  * @param 'twins' : array where the other entries are stored (up to 15)
+  * @return Number of other entries
+  */
+
+int Symmetries::cornersTwins(long entry, long *twins) const {
+    int c = entry / CORNERS_O;
+    int o = entry % CORNERS_O;
+    int stabilizer = this->cornersStabilizer[c];
+
+    int n = 0;
+    int s, k;
+    for (s = 1; s < SYMMETRIES; s++) {
+        if ((stabilizer & (1 << s)) == 0)
+            continue;
+
+        long twin = (long) c*CORNERS_O + this->cornersO[s][o];
+        bool repeated = (twin == entry);
+        for (k = 0; k < n; k++)
+            repeated = repeated || (twins[k] == twin);
+        if (!repeated) {
+            twins[n] = twin;
+            n++;
+        }
+    }
+
+    return n;
+};
+
+
+/**
+  * Gets the number of entries of the corners table
+  * @return Number of classes * 3^8
+  */
+
+long Symmetries::cornersEntries() const {
+    return (long) this->classes*CORNERS_O;
+};
+
+
+/**
+  * Gets the edges whose cost is looked up in edges1 through a symmetry
+  * @param 's' : symmetry (between 0 and 15)
+  * @return Cubies taken to the cubies of edges1 (see MoveTables::pattern),
+  *         in the same order
+  */
+
+const int *Symmetries::pattern(int s) const {
+    return this->patterns[s];
+};
+
+
+/**
+  * Gets the symmetries that give different lookups of a pattern of k edges:
+  * the identity (edges1), the half turn (edges2), and then every other
+  * symmetry that takes a new set of edges to edges1
+  * @param 'k'          : number of edges of the pattern
+  * @param 'symmetries' : array where the symmetries are stored (up to 16)
+  * @return Number of symmetries
+  */
+
+int Symmetries::edgesLookups(int k, int *symmetries) const {
+    //Identity and half turn first
+    int candidates[SYMMETRIES] = {0, MIRROR};
+    int c = 2;
+    int i, s, j;
+    for (s = 1; s < SYMMETRIES; s++) {
+        if (s != MIRROR) {
+            candidates[c] = s;
+            c++;
+        }
+    }
+
+    int sets[SYMMETRIES];
+    int n = 0;
+    for (i = 0; i < SYMMETRIES; i++) {
+        s = candidates[i];
+        int set = 0;
+        for (j = 0; j < k; j++)
+            set = set | (1 << this->patterns[s][j]);
+
+        bool repeated = false;
+        for (j = 0; j < n; j++)
+            repeated = repeated || (sets[j] == set);
+        if (!repeated) {
+            sets[n] = set;
+            symmetries[n] = s;
+            n++;
+        }
+    }
+
+    return n;
+};
+
+
+/**
+  * Gets the index in edges1 of the edges that a symmetry takes to edges1
+  * @param 's' : symmetry (between 0 and 15)
+  * @param 'k' : number of edges of the tables
+  * @param 'i' : index of a state in the pattern of the edges (see pattern)
+  * @return Index in edges1 of the turned state
+  */
+
+long Symmetries::turnEdges(int s, int k, long i) const {
+    if (s == 0)
+        return i;
+
+    if ((k == 6) && (this->edgesP[s] != NULL)) {
+        unsigned int image = this->edgesP[s][i / EDGES_O];
+        int positions = image & 0xFFFFF;
+        int orientations = (i % EDGES_O) ^ (image >> 20);
+
+        return (long) positions*EDGES_O + orientations;
+    }
+
+    long count = 1L << k;
+    int positions[EDGES_MAX];
+    MoveTables::unrankEdgesP(k, i / count, positions);
+
+    int flip;
+    int turned = this->turnPositions(s, k, positions, &flip);
+    return turned*count + ((i % count) ^ flip);
+};
+
+
+/**
+  * Builds the new position of every position under every symmetry.
+  * Symmetry s swaps X and Y if its bit 0 is set, and changes the direction
+  * of X, Y and Z if its bits 1, 2 and 3 are set
+  */
+
+void Symmetries::initializeSlots() {
+    int s, p, q, k;
+    for (s = 0; s < SYMMETRIES; s++) {
+        for (p = 0; p < 20; p++) {
+            int point[3] = {coordinates[p][0], coordinates[p][1],
+                            coordinates[p][2]};
+            if (s & 1) {
+                int temp = point[0];
+                point[0] = point[1];
+                point[1] = temp;
+            }
+            for (k = 0; k < 3; k++) {
+                if (s & (2 << k))
+                    point[k] = -point[k];
+            }
+
+            for (q = 0; q < 20; q++) {
+                if ((coordinates[q][0] == point[0]) &&
+                    (coordinates[q][1] == point[1]) &&
+                    (coordinates[q][2] == point[2]))
+                    this->slots[s][p] = q;
+            }
+        }
+    }
+
+    //Inverse of every symmetry
+    for (s = 0; s < SYMMETRIES; s++) {
+        for (k = 0; k < SYMMETRIES; k++) {
+            bool inverse = true;
+            for (p = 0; p < 20; p++)
+                inverse = inverse && (this->slots[k][this->slots[s][p]] == p);
+            if (inverse)
+                this->inverses[s] = k;
+        }
+    }
+};
+
+
+/**
+  * Builds the new cubie of every cubie under every symmetry.
+  *
+  * @section Description
+  *
+  * Orientations are the axis of one face of the cubie (the face that is
+  * on the Z axis in the goal for corners and most edges, and on the Y axis
+  * for the edges in positions 3, 7, 11 and 15). A symmetry moves that face
+  * to a face on the same axis, or on the swapped one. When the new face is
+  * not the one the new cubie is oriented by, the orientation is the axis of
+  * the other face of the edge
+  */
+
+void Symmetries::initializeCubies() {
+    Rubik goal;
+    goal.transformToGoal();
+
+    int s, i, b;
+    for (s = 0; s < SYMMETRIES; s++) {
+        for (i = 0; i < 20; i++) {
+            int cubie = this->slots[s][i];
+            int home = goal.getOrientation(i);
+            int newhome = goal.getOrientation(cubie);
+            if (s & 1)
+                home = (home & 1) | ((home & 4) >> 1) | ((home & 2) << 1);
+
+            for (b = 0; b < 256; b++) {
+                int position = b >> 3;
+                int orientation = b & 7;
+                if (position >= 20) {
+                    this->cubies[s][i][b] = b;
+                    continue;
+                }
+
+                int newposition = this->slots[s][position];
+                if (s & 1)
+                    orientation = (orientation & 1) |
+                                  ((orientation & 4) >> 1) |
+                                  ((orientation & 2) << 1);
+
+                //Axes of the two faces of an edge
+                int axes = 0;
+                int k;
+                for (k = 0; k < 3; k++) {
+                    if (coordinates[newposition][k] != 0)
+                        axes = axes | (4 >> k);
+                }
+
+                bool edge = (i >= 16) || (i % 2 != 0);
+                if (edge && (home != newhome) && (orientation & axes))
+                    orientation = axes ^ orientation;
+
+                this->cubies[s][i][b] = (newposition << 3) | orientation;
+            }
+        }
+    }
+};
+
+
+/**
+  * Builds the classes of corner positions and the turned orientations
+  */
+
+void Symmetries::initializeCorners() {
+    this->cornersClass = new int[CORNERS_P];
+    this->cornersSym = new unsigned char[CORNERS_P];
+    this->cornersRep = new int[CORNERS_P];
+    this->cornersStabilizer = new unsigned short[CORNERS_P];
+
+    //Orientations X, Y, Z are 0, 2 and 1 in the corners table (% 4)
+    int axis[3] = {4, 1, 2};
+    int s, x, k;
+
+    //Orientations of the eight corners, cubie 0 is the most significant
+    for (s = 0; s < SYMMETRIES; s++) {
+        for (x = 0; x < CORNERS_O; x++) {
+            int digits[8];
+            int y = x;
+            for (k = 7; k >= 0; k--) {
+                digits[k] = y % 3;
+                y = y / 3;
+            }
+
+            int turned[8];
+            for (k = 0; k < 8; k++) {
+                unsigned char cubie = ((k*2) << 3) | axis[digits[k]];
+                cubie = this->cubies[s][k*2][cubie];
+                turned[this->slots[s][k*2] / 2] = (cubie & 7) % 4;
+            }
+
+            int rank = 0;
+            for (k = 0; k < 8; k++)
+                rank = (rank*3) + turned[k];
+            this->cornersO[s][x] = rank;
+        }
+    }
+
+    for (x = 0; x < CORNERS_P; x++)
+        this->cornersClass[x] = -1;
+
+    //The representative of a class is its first position
+    this->classes = 0;
+    for (x = 0; x < CORNERS_P; x++) {
+        if (this->cornersClass[x] != -1)
+            continue;
+
+        int c = this->classes;
+        this->classes++;
+        this->cornersRep[c] = x;
+        this->cornersStabilizer[c] = 0;
+
+        int positions[8];
+        MoveTables::unrankCornersP(x, positions);
+        for (s = 0; s < SYMMETRIES; s++) {
+            int turned[8];
+            for (k = 0; k < 8; k++) {
+                int position = this->slots[s][positions[k]*2];
+                turned[this->slots[s][k*2] / 2] = position / 2;
+            }
+
+            int y = MoveTables::rankCornersP(turned);
+            if (y == x)
+                this->cornersStabilizer[c] |= 1 << s;
+            if (this->cornersClass[y] == -1) {
+                this->cornersClass[y] = c;
+                this->cornersSym[y] = this->inverses[s];   //Back to x
+            }
+        }
+    }
+};
+
+
+/**
+  * Builds the edges taken to edges1 by every symmetry, where they go, and
+  * the tables of the lookups of six edges
+  */
+
+void Symmetries::initializeEdges() {
+    const int *edges1 = MoveTables::pattern;
+
+    int s, j, q;
+    for (s = 0; s < SYMMETRIES; s++) {
+        for (j = 0; j < EDGES_MAX; j++) {
+            int cubie = this->slots[this->inverses[s]][edges1[j]];
+            this->patterns[s][j] = cubie;
+
+            //New number of every position, and whether the edge flips
+            for (q = 0; q < 12; q++) {
+                int position = q*2 + 1;
+                if (q >= 8)
+                    position = q + 8;
+
+                //Maximum orientation is X in the left and right faces, and
+                //Y in the middle face (see Rubik::isMaxOriented)
+                int max = 4;
+                if (position >= 16)
+                    max = 2;
+                unsigned char turned = (position << 3) | max;
+                turned = this->cubies[s][cubie][turned];
+
+                int moved = turned >> 3;
+                int newmax = 4;
+                if (moved >= 16)
+                    newmax = 2;
+
+                this->numbers[s][j][q] = moved / 2;
+                if (moved >= 16)
+                    this->numbers[s][j][q] = moved - 8;
+                this->flips[s][j][q] = (turned & 7) != newmax;
+            }
+        }
+        this->edgesP[s] = NULL;
+    }
+
+    //Tables of six edges, for the symmetries that give new lookups
+    int symmetries[SYMMETRIES];
+    int n = this->edgesLookups(6, symmetries);
+    int i, x;
+    for (i = 1; i < n; i++) {
+        s = symmetries[i];
+        this->edgesP[s] = new unsigned int[EDGES_P];
+
+        for (x = 0; x < EDGES_P; x++) {
+            int positions[6];
+            MoveTables::unrankEdgesP(6, x, positions);
+
+            int flip;
+            unsigned int rank = this->turnPositions(s, 6, positions, &flip);
+            this->edgesP[s][x] = (flip << 20) | rank;
+        }
+    }
+};
+
+
+/**
+  * Turns the positions of the first k edges of pattern(s)
+  * @param 's'         : symmetry (between 0 and 15)
+  * @param 'k'         : number of edges (6, 7 or 8)
+  * @param 'positions' : numbers of the positions of the k edges
+  * @param 'flip'      : where the mask of the edges that flip is stored
+  * @return Permutation of the positions of the edges of edges1
+  */
+
+int Symmetries::turnPositions(int s, int k, const int *positions,
+                              int *flip) const {
+    int turned[EDGES_MAX];
+    int mask = 0;
+    int j;
+    for (j = 0; j < k; j++) {
+        turned[j] = this->numbers[s][j][positions[j]];
+        //First edge is the most significant bit
+        if (this->flips[s][j][positions[j]])
+            mask = mask | (1 << (k - 1 - j));
+    }
+
+    *flip = mask;
+    return MoveTables::rankEdgesP(k, turned);
+};
@@ -0,0 +1,90 @@
+/**
+  * @file
+  * @author Gabriel Formica <gabrielformica93@gmail.com>
+  * @author Juliana Leon <julianaleon8@gmail.com>
+  *
+  * @section Description
+  *
+  * Symmetries class header
+  */
+
+#ifndef SYMMETRY_HH
+#define SYMMETRY_HH
+
+#include "rubik.hh"
+#include "movetables.hh"
+
+/*
+ * Number of symmetries of the cube that keep the top-bottom axis: the
+ * rotations and reflections that keep or swap the other two axes and
+ * change the direction of any of the three
+ */
+#define SYMMETRIES 16
+
+/*
+ * Half turn around the top-bottom axis. It takes edges2 to edges1
+ */
+#define MIRROR 6
+
+/*
+ * Symmetries of the cube. A symmetry S turns a configuration X into S X S'
+ * (S' is the inverse of S): the cube is rotated or reflected, and cubies
+ * and positions are renamed so that the goal is still the goal. Two
+ * configurations related by a symmetry are the same distance away from the
+ * goal, so a pattern database only needs one of them.
+ *
+ * - Corner positions are split in classes of positions related by a
+ *   symmetry (2768 classes instead of 8! positions). The corners table
+ *   keeps one entry for every class and corner orientation: a state is
+ *   looked up by moving its positions to the representative of their class
+ *   and turning its orientations by the same symmetry.
+ * - Edge tables only keep edges1. A symmetry S takes the edges that S'
+ *   takes to edges1 to the edges of edges1, so the cost of those edges is
+ *   looked up in edges1. A half turn around the top-bottom axis gives
+ *   edges2, and the other symmetries give other sets of edges (symmetries
+ *   that keep the set of edges give the same cost, so they are skipped).
+ *   Patterns of six edges are turned with a table, and larger ones by
+ *   turning every edge.
+ *
+ * The tables are built once, the first time they are needed, and shared by
+ * every thread
+ */
+class Symmetries {
+    private:
+        int slots[SYMMETRIES][20];              //New position of a position
+        int inverses[SYMMETRIES];
+        unsigned char cubies[SYMMETRIES][20][256];   //New cubie of a cubie
+        int *cornersClass;                      //[CORNERS_P] class
+        unsigned char *cornersSym;              //[CORNERS_P] to the class
+        int *cornersRep;                        //Representative of a class
+        unsigned short *cornersStabilizer;      //Symmetries that keep it
+        int classes;                            //Number of classes
+        unsigned short cornersO[SYMMETRIES][6561];   //Turned orientations
+        int patterns[SYMMETRIES][EDGES_MAX];    //Edges taken to edges1
+        int numbers[SYMMETRIES][EDGES_MAX][12]; //New number of a position
+        bool flips[SYMMETRIES][EDGES_MAX][12];  //Whether the edge flips
+        unsigned int *edgesP[SYMMETRIES];       //[EDGES_P] flips << 20 | new
+
+    public:
+        static const Symmetries &tables();
+        Rubik conjugate(int, Rubik) const;
+        long reduceCorners(long) const;
+        long cornersState(long) const;
+        int cornersTwins(long, long *) const;
+        long cornersEntries() const;
+        const int *pattern(int) const;
+        int edgesLookups(int, int *) const;
+        long turnEdges(int, int, long) const;
+    private:
+        Symmetries();
+        ~Symmetries();
+        Symmetries(const Symmetries &);             //Tables are never copied
+        Symmetries &operator=(const Symmetries &);
+        void initializeSlots();
+        void initializeCubies();
+        void initializeCorners();
+        void initializeEdges();
+        int turnPositions(int, int, const int *, int *) const;
+};
+
+#endif
@@ -69,46 +69,3 @@ int pow(int b, int e) {
     
     return pow;
 };
-
-
-/**
-  * Ranks the sub-set in the permutation from n-k...n-1 
-  * pieces of an array (sequence) of integers
-  * @param 'k'  :   size of subset
-  * @param 'n'  :   size of any of the permutations 
-  * @param 'seq'    : sequence to be rakend
-  * @param 'inverse': inverse of the identity
-  * @return Int of ranked k-permutation
-  */ 
-
-int rankAux(int k, int n, int *seq, int *inverse) {
-
-    if (n == k)
-        return 0;
-
-    int s = seq [n-1];
-    swap(&seq[n-1], &seq[inverse[n-1]]);
-    swap(&inverse[s], &inverse[n-1]);
-
-    return s + n*(rankAux(k,n-1, seq, inverse));
-};
-
-
-/**
-  * Unranks the subset of size k from n-k...n-1 of 
-  * an array (sequence) of integers
-  * @param 'k'  :   size of subset
-  * @param 'n'         :   size of any of the permutations 
-  * @param 'r'         :   ranked value to be unranked
-  * @param 'identity'  :   identity permutation
-  */
-
-void unrankAux(int k, int n, int r, int *identity) {
-
-    if (n > k) {
-        int temp = identity[n-1];
-        identity[n-1] = identity[r % n];
-        identity[r % n] = temp;
-        unrankAux(k,n-1, r / n, identity);
-    }
-};
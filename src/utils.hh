@@ -20,8 +20,82 @@ extern void swap(int *,int *);
 
 extern int pow(int,int);
 
-extern int rankAux(int,int,int *,int *);
+/*
+ * Ranking of permutations. These are defined here so calls with constant
+ * sizes are unrolled by the compiler
+ */
 
-extern void unrankAux(int,int,int,int *);
+/**
+  * Ranks a k-permutation of {0, ..., n-1} (n <= 12) without recursion.
+  * The order is the one of Myrvold and Ruskey: the k elements are placed
+  * in the last k places of a permutation of n elements, and the element
+  * in the last place is swapped with n-1 before ranking the first n-1.
+  * Elements not in the k-permutation never reach the last places, so only
+  * the places of the k elements are kept, and there are no branches
+  * @param 'k'        :  number of elements (k = n ranks a permutation)
+  * @param 'n'        :  size of the set
+  * @param 'elements' :  the k elements
+  * @return Rank of the k-permutation (between 0 and n!/(n-k)! - 1)
+  */
+
+static inline int rankPermutation(int k, int n, const int *elements) {
+    //Elements in the last k places, and the place of every element (n if
+    //it isn't there: seq[n] is never read)
+    int seq[13];
+    int place[12];
+    int i;
+    for (i = 0; i < n; i++)
+        place[i] = n;
+    for (i = 0; i < k; i++) {
+        seq[n - k + i] = elements[i];
+        place[elements[i]] = n - k + i;
+    }
+
+    int rank = 0;
+    int weight = 1;
+    int m;
+    for (m = n; m > n - k; m--) {
+        int s = seq[m - 1];
+        int j = place[m - 1];
+
+        //s takes the place of m-1, which goes to the last place
+        seq[j] = s;
+        place[s] = j;
+
+        rank = rank + s*weight;
+        weight = weight*m;
+    }
+
+    return rank;
+};
+
+
+/**
+  * Unranks a k-permutation of {0, ..., n-1} (n <= 12) without recursion,
+  * in the order of rankPermutation
+  * @param 'k'        :  number of elements (k = n unranks a permutation)
+  * @param 'n'        :  size of the set
+  * @param 'r'        :  rank (between 0 and n!/(n-k)! - 1)
+  * @param 'elements' :  array where the k elements are stored
+  */
+
+static inline void unrankPermutation(int k, int n, int r, int *elements) {
+    int seq[12];
+    int i;
+    for (i = 0; i < n; i++)
+        seq[i] = i;
+
+    int m;
+    for (m = n; m > n - k; m--) {
+        int j = r % m;
+        int temp = seq[m - 1];
+        seq[m - 1] = seq[j];
+        seq[j] = temp;
+        r = r / m;
+    }
+
+    for (i = 0; i < k; i++)
+        elements[i] = seq[n - k + i];
+};
 
 #endif